@@ -0,0 +1,146 @@
+#include "analysis.h"
+#include "board.h"
+#include "epd.h"
+#include "search.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+std::string toJsonString(std::string_view text) {
+  const char *hex_digits = "0123456789abcdef";
+  std::string json = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      json += '\\';
+      json += c;
+    } else if ((unsigned char)c < 0x20) {
+      json += "\\u00";
+      json += hex_digits[c >> 4];
+      json += hex_digits[c & 0xF];
+    } else {
+      json += c;
+    }
+  }
+  return json + "\"";
+}
+
+std::string analyzeLine(std::string_view line, uint64_t line_number,
+                        uint8_t depth, PrincipalVariation *pv) {
+  std::string json = "{\"line\":" + std::to_string(line_number);
+  EpdPosition position;
+  size_t fen_length = getFenLength(line);
+  FenError error =
+      fenToGameState(line.substr(0, fen_length), position.game_state);
+  if (error != FEN_OK) {
+    return json + ",\"error\":" +
+           toJsonString(std::string("invalid fen: ") +
+                        fenErrorToString(error)) +
+           "}";
+  }
+  parseEpdOperations(line.substr(fen_length), position);
+
+  std::string_view acd = position.analysis_depth;
+  uint16_t line_depth;
+  if (!acd.empty() &&
+      std::from_chars(acd.data(), acd.data() + acd.size(), line_depth).ec ==
+          std::errc()) {
+    depth = std::min<uint16_t>(line_depth, MAX_SEARCH_DEPTH);
+  }
+  depth = std::clamp<uint8_t>(depth, 1, MAX_SEARCH_DEPTH);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  NegamaxTuple result =
+      negamax(position.game_state, depth,
+              position.game_state.side_to_move == WHITE ? 1 : -1, -INT16_MAX,
+              INT16_MAX, pv);
+  auto end = std::chrono::high_resolution_clock::now();
+  uint64_t time_ms = (end - start).count() / 1000000;
+
+  if (!position.id.empty()) {
+    json += ",\"id\":" + toJsonString(position.id);
+  }
+  // Without legal moves, there is no best move.
+  json += ",\"bestmove\":";
+  json += pv->length ? toJsonString(result.move.toString()) : "null";
+  json += ",\"score\":" + std::to_string(result.score);
+  json += ",\"depth\":" + std::to_string(depth);
+  json += ",\"pv\":[";
+  for (uint8_t i = 0; i < pv->length; i++) {
+    json += (i ? "," : "") + toJsonString(pv->moves[i].toString());
+  }
+  json += "],\"nodes\":" + std::to_string(result.nodes_searched);
+  json += ",\"time_ms\":" + std::to_string(time_ms) + "}";
+  return json;
+}
+
+// Input lines waiting to be analyzed. Bounded, so a large input is streamed
+// instead of read up front.
+struct AnalysisQueue {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::pair<uint64_t, std::string>> lines;
+  bool closed = false;
+};
+
+void runBatchAnalysis(std::istream &input, uint8_t depth, uint32_t n_threads) {
+  n_threads = std::max(1u, n_threads);
+  const size_t MAX_QUEUED_LINES = 64 * n_threads;
+  AnalysisQueue queue;
+  std::mutex output_mutex;
+
+  // The move generation and evaluation tables are read-only, and shared by
+  // the workers. Each worker owns its search state.
+  std::vector<std::thread> workers;
+  for (uint32_t i = 0; i < n_threads; i++) {
+    workers.emplace_back([&]() {
+      std::vector<PrincipalVariation> pv(MAX_SEARCH_DEPTH + 1);
+      while (true) {
+        std::pair<uint64_t, std::string> line;
+        {
+          std::unique_lock<std::mutex> lock(queue.mutex);
+          queue.changed.wait(
+              lock, [&]() { return queue.closed || !queue.lines.empty(); });
+          if (queue.lines.empty()) {
+            return;
+          }
+          line = std::move(queue.lines.front());
+          queue.lines.pop_front();
+        }
+        queue.changed.notify_all();
+
+        std::string result =
+            analyzeLine(line.second, line.first, depth, pv.data());
+        std::lock_guard<std::mutex> lock(output_mutex);
+        std::cout << result << std::endl;
+      }
+    });
+  }
+
+  std::string line;
+  for (uint64_t line_number = 1; std::getline(input, line); line_number++) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    queue.changed.wait(
+        lock, [&]() { return queue.lines.size() < MAX_QUEUED_LINES; });
+    queue.lines.emplace_back(line_number, std::move(line));
+    lock.unlock();
+    queue.changed.notify_all();
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.closed = true;
+  }
+  queue.changed.notify_all();
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "search.h"
+#include <istream>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+/** Returns the text as a quoted JSON string, escaping quotes, backslashes and
+ * control characters.
+ *
+ * @param text: Text.
+ * @return JSON string.
+ */
+std::string toJsonString(std::string_view text);
+
+/** Analyzes a line of the batch analysis input: a FEN or EPD position. The acd
+ * operation overrides the search depth, and the id operation is echoed.
+ *
+ * @param line: Input line.
+ * @param line_number: Number of the line in the input, starting at 1.
+ * @param depth: Search depth, unless overridden by the line.
+ * @param pv: Principal variations used by the search, MAX_SEARCH_DEPTH + 1 of
+ * them. Owned by the calling thread.
+ * @return Result as a JSON object, on a single line: the best move, score, PV,
+ * depth, nodes and time in ms, or the error if the position is invalid.
+ */
+std::string analyzeLine(std::string_view line, uint64_t line_number,
+                        uint8_t depth, PrincipalVariation *pv);
+
+/** Reads positions from the input, one per line, and searches them on a fixed
+ * pool of threads. Each result is printed as a JSON line as soon as its search
+ * completes, so results are in completion order and carry their line number.
+ * Blank lines are ignored.
+ *
+ * @param input: Input stream, e.g. std::cin or a file.
+ * @param depth: Default search depth.
+ * @param n_threads: Number of threads.
+ */
+void runBatchAnalysis(std::istream &input, uint8_t depth, uint32_t n_threads);
@@ -0,0 +1,222 @@
+#include "bench.h"
+#include "board.h"
+#include "constants.h"
+#include "epd.h"
+#include "evaluate.h"
+#include "move_generator.h"
+#include "packed_position.h"
+#include "search.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Mix of opening, middlegame and endgame positions.
+const std::string bench_fens[] = {
+    fen_standard,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1"};
+
+/** Returns the positions reachable in two plies from the bench positions.
+ *
+ * @return Positions.
+ */
+std::vector<GameState> getBatchPositions(void) {
+  std::vector<GameState> positions;
+  for (const std::string &fen : bench_fens) {
+    GameState game_state;
+    fenToGameState(fen, game_state);
+    Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+    bool check;
+    uint8_t n_moves = generateMoves(game_state, moves, check);
+    for (uint8_t i = 0; i < n_moves; i++) {
+      GameState child = game_state;
+      applyMove(moves[i], child);
+      Move child_moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+      uint8_t n_child_moves = generateMoves(child, child_moves, check);
+      for (uint8_t j = 0; j < n_child_moves; j++) {
+        positions.push_back(child);
+        applyMove(child_moves[j], positions.back());
+      }
+    }
+  }
+  return positions;
+}
+
+/** Compares the throughput of the batch evaluation with evaluating the
+ *  positions one at a time.
+ */
+void runBatchEvaluationBenchmark(void) {
+  const uint8_t N_REPETITIONS = 20;
+  std::vector<GameState> positions = getBatchPositions();
+  PositionBatch batch;
+  for (uint8_t i = 0; i < N_REPETITIONS; i++) {
+    for (const GameState &game_state : positions) {
+      batch.addPosition(game_state);
+    }
+  }
+  std::vector<int16_t> scores(batch.size());
+  std::vector<int16_t> material_scores(batch.size());
+  auto seconds = [](auto start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return (double)(end - start).count() / 1000000000;
+  };
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint8_t i = 0; i < N_REPETITIONS; i++) {
+    for (uint32_t j = 0; j < positions.size(); j++) {
+      scores[i * positions.size() + j] = evaluatePosition(positions[j]);
+    }
+  }
+  double single_seconds = seconds(start);
+
+  start = std::chrono::high_resolution_clock::now();
+  evaluatePositions(batch, scores.data());
+  double batch_seconds = seconds(start);
+
+  start = std::chrono::high_resolution_clock::now();
+  evaluateMaterialAndPositions(batch, material_scores.data());
+  double material_seconds = seconds(start);
+
+  std::cout << "Evaluated positions: " << batch.size() << "." << std::endl;
+  std::cout << "Single evaluation positions per second: "
+            << batch.size() / single_seconds << std::endl;
+  std::cout << "Batch evaluation positions per second: "
+            << batch.size() / batch_seconds << std::endl;
+  std::cout << "Batch material/position positions per second: "
+            << batch.size() / material_seconds << std::endl;
+}
+
+/** Compares the throughput of the FEN parser with unpacking the same positions
+ * from the packed position format.
+ */
+void runPositionParseBenchmark(void) {
+  const uint32_t N_REPETITIONS = 100000;
+  std::vector<PackedPosition> packed_positions;
+  for (const std::string &fen : bench_fens) {
+    PositionRecord record;
+    fenToGameState(fen, record.game_state);
+    packed_positions.emplace_back();
+    packPosition(record, packed_positions.back());
+  }
+  auto seconds = [](auto start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return (double)(end - start).count() / 1000000000;
+  };
+
+  uint32_t n_parsed = 0;
+  GameState game_state;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < N_REPETITIONS; i++) {
+    for (const std::string &fen : bench_fens) {
+      n_parsed += fenToGameState(fen, game_state) == FEN_OK;
+    }
+  }
+  double fen_seconds = seconds(start);
+
+  uint32_t n_unpacked = 0;
+  PositionRecord record;
+  start = std::chrono::high_resolution_clock::now();
+  for (uint32_t i = 0; i < N_REPETITIONS; i++) {
+    for (const PackedPosition &packed : packed_positions) {
+      n_unpacked += unpackPosition(packed, record);
+    }
+  }
+  double packed_seconds = seconds(start);
+
+  std::cout << "Parsed positions: " << n_parsed << "." << std::endl;
+  std::cout << "FENs parsed per second: " << n_parsed / fen_seconds
+            << std::endl;
+  std::cout << "Packed positions unpacked per second: "
+            << n_unpacked / packed_seconds << std::endl;
+}
+
+/** Compares loading an EPD file line by line with std::getline with loading it
+ * with the memory-mapped, parallel EPD loader.
+ */
+void runEpdLoadBenchmark(void) {
+  const uint32_t N_REPETITIONS = 25000;
+  const std::string path = "bench_positions.epd";
+  {
+    std::ofstream file(path);
+    for (uint32_t i = 0; i < N_REPETITIONS; i++) {
+      for (const std::string &fen : bench_fens) {
+        file << fen << " bm e4; id \"bench." << i << "\";\n";
+      }
+    }
+  }
+  auto seconds = [](auto start) {
+    auto end = std::chrono::high_resolution_clock::now();
+    return (double)(end - start).count() / 1000000000;
+  };
+
+  auto start = std::chrono::high_resolution_clock::now();
+  std::ifstream file(path);
+  std::vector<GameState> positions;
+  uint64_t n_bytes = 0;
+  std::string line;
+  while (std::getline(file, line)) {
+    n_bytes += line.size() + 1;
+    GameState game_state;
+    if (fenToGameState(line.substr(0, getFenLength(line)), game_state) ==
+        FEN_OK) {
+      positions.push_back(game_state);
+    }
+  }
+  double getline_seconds = seconds(start);
+
+  start = std::chrono::high_resolution_clock::now();
+  size_t n_loaded = EpdFile(path).getPositions().size();
+  double mapped_seconds = seconds(start);
+  std::remove(path.c_str());
+
+  std::cout << "Loaded EPD positions: " << n_loaded << "." << std::endl;
+  std::cout << "Line by line EPD MB per second: "
+            << n_bytes / getline_seconds / 1000000 << std::endl;
+  std::cout << "Memory-mapped EPD MB per second: "
+            << n_bytes / mapped_seconds / 1000000 << std::endl;
+}
+
+void runBenchmark(uint8_t depth) {
+  EvaluationStats &stats = getEvaluationStats();
+  stats = EvaluationStats();
+  uint64_t total_nodes = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (const std::string &fen : bench_fens) {
+    GameState game_state;
+    fenToGameState(fen, game_state);
+    NegamaxTuple result =
+        negamax(game_state, depth, game_state.side_to_move == WHITE ? 1 : -1);
+    total_nodes += result.nodes_searched;
+    std::cout << "Position: " << fen << std::endl;
+    std::cout << "Best move: " << result.move.toString()
+              << ", score: " << result.score
+              << ", nodes: " << result.nodes_searched << std::endl;
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double seconds = (double)(end - start).count() / 1000000000;
+
+  std::cout << "Time elapsed: " << seconds << " s." << std::endl;
+  std::cout << "Total nodes searched: " << total_nodes << "." << std::endl;
+  std::cout << "NPS: " << total_nodes / seconds << std::endl;
+  std::cout << "Evaluations: " << stats.n_evaluations << "." << std::endl;
+  std::cout << "Evaluations per second: " << stats.n_evaluations / seconds
+            << std::endl;
+  std::cout << "Lazy evaluation exits: " << stats.n_lazy_exits << " ("
+            << (stats.n_evaluations
+                    ? 100.0 * stats.n_lazy_exits / stats.n_evaluations
+                    : 0)
+            << "%)." << std::endl;
+
+  runBatchEvaluationBenchmark();
+  runPositionParseBenchmark();
+  runEpdLoadBenchmark();
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+/** Searches a fixed set of positions and prints search and evaluation
+ * performance statistics.
+ *
+ * @param depth: Depth to search each position to.
+ */
+void runBenchmark(uint8_t depth);
@@ -2,8 +2,9 @@
 #include "constants.h"
 #include "helper_functions.h"
 #include "move.h"
+#include "move_generator.h"
+#include <array>
 #include <iostream>
-#include <regex>
 #include <string>
 
 /** Fills out char grid according to the game state.
@@ -12,36 +13,13 @@
  * @param grid: Character grid.
  */
 void populateGridFromGameState(const GameState &game_state, char grid[8][8]) {
+  const char piece_chars[N_COLORS][N_PIECE_TYPES + 1] = {"PNBRQK", "pnbrqk"};
   for (int8_t row = 7; row >= 0; row--) {
     for (uint8_t col = 0; col < 8; col++) {
-      uint8_t bit = ((7 - row) * 8) + col;
-      if (game_state.white.pawn & (1ULL << bit)) {
-        grid[row][col] = 'P';
-      } else if (game_state.white.rook & (1ULL << bit)) {
-        grid[row][col] = 'R';
-      } else if (game_state.white.knight & (1ULL << bit)) {
-        grid[row][col] = 'N';
-      } else if (game_state.white.bishop & (1ULL << bit)) {
-        grid[row][col] = 'B';
-      } else if (game_state.white.queen & (1ULL << bit)) {
-        grid[row][col] = 'Q';
-      } else if (game_state.white.king & (1ULL << bit)) {
-        grid[row][col] = 'K';
-      } else if (game_state.black.pawn & (1ULL << bit)) {
-        grid[row][col] = 'p';
-      } else if (game_state.black.rook & (1ULL << bit)) {
-        grid[row][col] = 'r';
-      } else if (game_state.black.knight & (1ULL << bit)) {
-        grid[row][col] = 'n';
-      } else if (game_state.black.bishop & (1ULL << bit)) {
-        grid[row][col] = 'b';
-      } else if (game_state.black.queen & (1ULL << bit)) {
-        grid[row][col] = 'q';
-      } else if (game_state.black.king & (1ULL << bit)) {
-        grid[row][col] = 'k';
-      } else {
-        grid[row][col] = ' ';
-      }
+      Piece piece = game_state.board[((7 - row) * 8) + col];
+      grid[row][col] = piece == NO_PIECE ? ' '
+                                         : piece_chars[getPieceColor(piece)]
+                                                      [getPieceType(piece)];
     }
   }
 }
@@ -72,316 +50,438 @@ void printBoard(const GameState &game_state) {
   std::cout << dividing_line << std::endl;
 }
 
-void fenToGameState(const std::string fen, GameState &game_state) {
-  std::string regex_string =
-      "^ *([rnbqkpRNBQKP1-8]+/){7}([rnbqkpRNBQKP1-8]+) ([wb]) "
-      "(([kqKQ]{1,4})|(-)) (([a-h][36])|(-)) *(.*)$";
+const char *fenErrorToString(FenError error) {
+  switch (error) {
+  case FEN_OK:
+    return "valid FEN";
+  case FEN_MISSING_FIELD:
+    return "missing FEN field";
+  case FEN_INVALID_BOARD:
+    return "invalid piece placement";
+  case FEN_INVALID_PIECE_COUNT:
+    return "position not legal/possible";
+  case FEN_INVALID_SIDE_TO_MOVE:
+    return "invalid side to move";
+  case FEN_INVALID_CASTLING:
+    return "invalid castling rights";
+  case FEN_INVALID_EN_PASSANT:
+    return "invalid en passant square";
+  case FEN_INVALID_MOVE_COUNTER:
+    return "invalid halfmove clock or fullmove number";
+  case FEN_TRAILING_INPUT:
+    return "unexpected input after the FEN";
+  default:
+    return "unknown FEN error";
+  }
+}
 
-  if (!regex_match(fen, std::regex(regex_string))) {
-    logErrorAndExit("ERROR: Not a valid FEN.");
-    return;
+/** Parses the piece placement field of the FEN.
+ *
+ * @param field: Piece placement field.
+ * @param game_state: Game state.
+ * @return FEN_OK, or the first error found.
+ */
+FenError parseFenBoard(std::string_view field, GameState &game_state) {
+  const std::string_view piece_chars = "PNBRQKpnbrqk";
+  uint8_t rank = 7;
+  uint8_t file = 0;
+  for (char c : field) {
+    if (c == '/') {
+      if (file != 8 || rank == 0) {
+        return FEN_INVALID_BOARD;
+      }
+      rank--;
+      file = 0;
+      continue;
+    }
+    if (c >= '1' && c <= '8') {
+      file += c - '0';
+      if (file > 8) {
+        return FEN_INVALID_BOARD;
+      }
+      continue;
+    }
+    size_t index = piece_chars.find(c);
+    if (index == std::string_view::npos || file == 8) {
+      return FEN_INVALID_BOARD;
+    }
+    uint8_t color = index / N_PIECE_TYPES;
+    uint8_t piece_type = index % N_PIECE_TYPES;
+    if (piece_type == PAWN && (rank == 0 || rank == 7)) {
+      return FEN_INVALID_BOARD;
+    }
+    game_state.pieces[color][piece_type] |= 1ULL << (rank * 8 + file);
+    file++;
   }
+  return rank == 0 && file == 8 ? FEN_OK : FEN_INVALID_BOARD;
+}
 
-  // Counters to validate FEN is a legal and possible position.
-  // TODO: validate the castling flags and rook/king location.
+bool hasPossiblePieceCounts(const GameState &game_state) {
+  const uint8_t initial_counts[N_PIECE_TYPES] = {8, 2, 2, 2, 1, 1};
+  for (uint8_t color = WHITE; color < N_COLORS; color++) {
+    uint8_t counts[N_PIECE_TYPES];
+    for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+      counts[piece_type] = countSetBits(game_state.pieces[color][piece_type]);
+    }
+    uint8_t n_promoted = 0;
+    for (uint8_t piece_type = KNIGHT; piece_type <= QUEEN; piece_type++) {
+      if (counts[piece_type] > initial_counts[piece_type]) {
+        n_promoted += counts[piece_type] - initial_counts[piece_type];
+      }
+    }
+    if (counts[KING] != 1 || counts[PAWN] > 8 ||
+        n_promoted > 8 - counts[PAWN]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void dropImpossibleCastlingRights(GameState &game_state) {
+  const uint64_t rooks[4] = {WHITE_ROOK_STARTING_POSITION_KINGSIDE,
+                             WHITE_ROOK_STARTING_POSITION_QUEENSIDE,
+                             BLACK_ROOK_STARTING_POSITION_KINGSIDE,
+                             BLACK_ROOK_STARTING_POSITION_QUEENSIDE};
+  for (uint8_t index = 0; index < 4; index++) {
+    uint8_t color = index / 2;
+    bool possible =
+        (game_state.pieces[color][KING] & (0x10ULL << (color * 56))) &&
+        (game_state.pieces[color][ROOK] & rooks[index]);
+    if (!possible) {
+      game_state.castling_rights &= ~(1 << index);
+    }
+  }
+}
+
+bool isPossibleEnPassant(const GameState &game_state, uint8_t square) {
+  // The square is behind the pawn that just moved 2 squares.
+  if (square / 8 != (game_state.side_to_move == WHITE ? 5 : 2)) {
+    return false;
+  }
+  Color enemy = Color(game_state.side_to_move ^ 1);
+  int8_t forward = game_state.side_to_move == WHITE ? -8 : 8;
+  uint64_t occupied = 0;
+  for (uint8_t color = WHITE; color < N_COLORS; color++) {
+    for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+      occupied |= game_state.pieces[color][piece_type];
+    }
+  }
+  return (game_state.pieces[enemy][PAWN] & (1ULL << (square + forward))) &&
+         !(occupied & ((1ULL << square) | (1ULL << (square - forward))));
+}
+
+/** Parses the castling field of the FEN.
+ *
+ * @param field: Castling field.
+ * @param game_state: Game state.
+ * @return FEN_OK, or the first error found.
+ */
+FenError parseFenCastling(std::string_view field, GameState &game_state) {
+  if (field == "-") {
+    return FEN_OK;
+  }
+  const std::string_view castling_chars = "KQkq";
+  for (char c : field) {
+    size_t index = castling_chars.find(c);
+    if (index == std::string_view::npos ||
+        (game_state.castling_rights & (1 << index))) {
+      return FEN_INVALID_CASTLING;
+    }
+    game_state.castling_rights |= 1 << index;
+  }
+  return field.empty() ? FEN_MISSING_FIELD : FEN_OK;
+}
+
+/** Parses a move counter field of the FEN.
+ *
+ * @param field: Move counter field.
+ * @param counter: Move counter, populated by this function.
+ * @return True if the field is a number that fits the counter.
+ */
+bool parseFenMoveCounter(std::string_view field, uint16_t &counter) {
+  uint32_t value = 0;
+  for (char c : field) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    value = value * 10 + (c - '0');
+    if (value > UINT16_MAX) {
+      return false;
+    }
+  }
+  counter = value;
+  return !field.empty();
+}
+
+FenError fenToGameState(std::string_view fen, GameState &game_state) {
   // TODO: make sure kings are separated by at least 1 square.
-  // TODO: the sum of the pieces and empty squares sum to 8 per rank.
-  // TODO: there should be no consecutive numbers.
   // TODO: non active color is not in check.
   // For more info:
   // https://chess.stackexchange.com/questions/1482/how-do-you-know-when-a-fen-position-is-legal
-  uint8_t n_p = 0, n_r = 0, n_n = 0, n_b = 0, n_q = 0, n_k = 0, n_P = 0,
-          n_R = 0, n_N = 0, n_B = 0, n_Q = 0, n_K = 0;
+  GameState parsed;
+  size_t pos = 0;
 
-  uint8_t byte = 7;
-  uint8_t bit = 0;
+  std::string_view field = getNextToken(fen, pos);
+  if (field.empty()) {
+    return FEN_MISSING_FIELD;
+  }
+  if (FenError error = parseFenBoard(field, parsed)) {
+    return error;
+  }
+  if (!hasPossiblePieceCounts(parsed)) {
+    return FEN_INVALID_PIECE_COUNT;
+  }
 
-  // Populate piece positions.
-  for (uint8_t i = 0; i < fen.find(' '); i++) {
-    // Check for empty positions.
-    if (isdigit(fen[i])) {
-      bit += fen[i] - '0';
-      continue;
+  field = getNextToken(fen, pos);
+  if (field.empty()) {
+    return FEN_MISSING_FIELD;
+  }
+  if (field != "w" && field != "b") {
+    return FEN_INVALID_SIDE_TO_MOVE;
+  }
+  parsed.side_to_move = field == "w" ? WHITE : BLACK;
+
+  field = getNextToken(fen, pos);
+  if (FenError error = parseFenCastling(field, parsed)) {
+    return error;
+  }
+  dropImpossibleCastlingRights(parsed);
+
+  field = getNextToken(fen, pos);
+  if (field.empty()) {
+    return FEN_MISSING_FIELD;
+  }
+  if (field != "-") {
+    if (field.size() != 2 || field[0] < 'a' || field[0] > 'h' ||
+        field[1] < '1' || field[1] > '8') {
+      return FEN_INVALID_EN_PASSANT;
     }
-    switch (fen[i]) {
-    case 'p':
-      if (byte == 0 || byte == 7) {
-        logErrorAndExit("ERROR: Pawns cannot be on rank 1 or rank 8.");
-        memset(&game_state, 0, sizeof(GameState));
-        return;
-      }
-      game_state.black.pawn += 1ull << (byte * 8 + bit);
-      n_p++;
-      break;
-    case 'r':
-      game_state.black.rook += (1ull << (byte * 8 + bit));
-      n_r++;
-      break;
-    case 'n':
-      game_state.black.knight += 1ull << (byte * 8 + bit);
-      n_n++;
-      break;
-    case 'b':
-      game_state.black.bishop += 1ull << (byte * 8 + bit);
-      n_b++;
-      break;
-    case 'q':
-      game_state.black.queen += 1ull << (byte * 8 + bit);
-      n_q++;
-      break;
-    case 'k':
-      game_state.black.king += 1ull << (byte * 8 + bit);
-      n_k++;
-      break;
-    case 'P':
-      if (byte == 0 || byte == 7) {
-        logErrorAndExit("ERROR: Pawns cannot be on rank 1 or rank 8.");
-        memset(&game_state, 0, sizeof(GameState));
-        return;
-      }
-      game_state.white.pawn += 1ull << (byte * 8 + bit);
-      n_P++;
-      break;
-    case 'R':
-      game_state.white.rook += 1ull << (byte * 8 + bit);
-      n_R++;
-      break;
-    case 'N':
-      game_state.white.knight += 1ull << (byte * 8 + bit);
-      n_N++;
-      break;
-    case 'B':
-      game_state.white.bishop += 1ull << (byte * 8 + bit);
-      n_B++;
-      break;
-    case 'Q':
-      game_state.white.queen += 1ull << (byte * 8 + bit);
-      n_Q++;
-      break;
-    case 'K':
-      game_state.white.king += 1ull << (byte * 8 + bit);
-      n_K++;
-      break;
-    case '/':
-      byte -= 1;
-      bit = 0;
-      continue;
-    default:
-      logErrorAndExit("ERROR: Unknown character in FEN string!");
-      break;
+    uint8_t square = (field[1] - '1') * 8 + (field[0] - 'a');
+    if (!isPossibleEnPassant(parsed, square)) {
+      return FEN_INVALID_EN_PASSANT;
     }
-    bit++;
-  }
-
-  // Piece count sanity checks.
-  int8_t n_p_missing = 8 - n_p;
-  int8_t n_P_missing = 8 - n_P;
-  uint8_t n_promoted = (n_r > 2 ? n_r - 2 : 0) + (n_n > 2 ? n_n - 2 : 0) +
-                       (n_b > 2 ? n_b - 2 : 0) + (n_q > 1 ? n_q - 1 : 0);
-  uint8_t n_Promoted = (n_R > 2 ? n_R - 2 : 0) + (n_N > 2 ? n_N - 2 : 0) +
-                       (n_B > 2 ? n_B - 2 : 0) + (n_Q > 1 ? n_Q - 1 : 0);
-  if (n_P > 8 || n_p > 8 || n_K != 1 || n_k != 1 || n_p_missing < n_promoted ||
-      n_P_missing < n_Promoted) {
-    logErrorAndExit("ERROR: FEN position not legal/possible.");
-    memset(&game_state, 0, sizeof(GameState));
-    return;
+    parsed.en_passant = square;
   }
 
-  // Populate extra game state data.
-  // TODO: Add half move and full move functionality. The 4th and 5th fields.
-  uint8_t field = 1; // 1: turn, 2: castling flags, 3: en passant.
-  for (uint8_t i = fen.find(' ') + 1; i < fen.length(); i++) {
-    switch (field) {
-    case 1:
-      if (fen[i] == 'w') {
-        game_state.whites_turn = true;
-        field++;
-      } else if (fen[i] == 'b') {
-        game_state.whites_turn = false;
-        field++;
-      }
-      continue;
-    case 2:
-      if (((game_state.white.can_king_side_castle ||
-            game_state.white.can_queen_side_castle ||
-            game_state.black.can_king_side_castle ||
-            game_state.black.can_queen_side_castle) &&
-           fen[i] == ' ') ||
-          fen[i] == '-') {
-        field++;
-      } else if (fen[i] == 'K') {
-        game_state.white.can_king_side_castle = true;
-      } else if (fen[i] == 'Q') {
-        game_state.white.can_queen_side_castle = true;
-      } else if (fen[i] == 'k') {
-        game_state.black.can_king_side_castle = true;
-      } else if (fen[i] == 'q') {
-        game_state.black.can_queen_side_castle = true;
-      }
-      continue;
-    case 3:
-      if (fen[i] >= 'a' && fen[i] <= 'h') {
-        uint8_t col = fen[i] - 'a';
-        uint8_t row = fen[i + 1] - '0' - 1;
-        game_state.en_passant = row * 8 + col;
-      }
-      break;
-      ;
-    default:
-      logErrorAndExit("ERROR: Unexpected field value.");
+  // The move counters are optional, but come as a pair.
+  field = getNextToken(fen, pos);
+  if (!field.empty()) {
+    if (!parseFenMoveCounter(field, parsed.halfmove_clock) ||
+        !parseFenMoveCounter(getNextToken(fen, pos),
+                             parsed.fullmove_number)) {
+      return FEN_INVALID_MOVE_COUNTER;
+    }
+  }
+  if (!getNextToken(fen, pos).empty()) {
+    return FEN_TRAILING_INPUT;
+  }
+
+  populateBoard(parsed);
+  updateCheckState(parsed);
+  game_state = parsed;
+  return FEN_OK;
+}
+
+size_t getFenLength(std::string_view line) {
+  size_t pos = 0;
+  size_t end = 0;
+  for (uint8_t i = 0; i < 6; i++) {
+    std::string_view field = getNextToken(line, pos);
+    uint16_t counter;
+    if (field.empty() || (i >= 4 && !parseFenMoveCounter(field, counter))) {
       break;
     }
+    end = pos;
   }
+  return end;
 }
 
-/** Checks for captured pieces and updates the enemy player state accordingly.
+/** Generates the Zobrist keys with the splitmix64 generator. The first 12 * 64
+ * keys are per piece and square (color major, then piece type), followed by 1
+ * side to move key, 4 castling keys and 8 en passant file keys.
  *
- * @param white_to_move: Flag that denotes turn.
- * @param P: Active player's pawn bitboard.
- * @param enemy_player: Enemy player's state.
- * @param en_passant: The en passant bit, if applicable.
- * @param initial: Bitboard of the moving piece, pre-move.
- * @param final: Bitboard of the moving piece, post-move.
+ * @return Zobrist keys.
  */
-void handleCapturedPiece(bool white_to_move, uint64_t P,
-                         ColorState &enemy_player, int8_t en_passant,
-                         uint64_t initial, uint64_t final) {
-  uint64_t ENEMY_PIECES = enemy_player.getOccupiedBitboard();
-
-  if (ENEMY_PIECES & final) {
-    if (enemy_player.pawn & final) {
-      enemy_player.pawn &= ~final;
-      return;
-    }
-    if (enemy_player.knight & final) {
-      enemy_player.knight &= ~final;
-      return;
-    }
-    if (enemy_player.bishop & final) {
-      enemy_player.bishop &= ~final;
-      return;
-    }
-    if (enemy_player.queen & final) {
-      enemy_player.queen &= ~final;
-      return;
+constexpr std::array<uint64_t, 12 * 64 + 13> generateZobristKeys(void) {
+  std::array<uint64_t, 12 * 64 + 13> keys = {};
+  uint64_t seed = 0x5EED0F0E0E5C4E55;
+  for (uint64_t &key : keys) {
+    seed += 0x9E3779B97F4A7C15;
+    uint64_t z = seed;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    key = z ^ (z >> 31);
+  }
+  return keys;
+}
+
+constexpr std::array<uint64_t, 12 * 64 + 13> zobrist_keys =
+    generateZobristKeys();
+const uint16_t ZOBRIST_SIDE = 12 * 64;
+const uint16_t ZOBRIST_CASTLING = ZOBRIST_SIDE + 1;
+const uint16_t ZOBRIST_EN_PASSANT = ZOBRIST_CASTLING + 4;
+
+/** Combines the Zobrist keys of the 4 castling rights into a key per castling
+ * rights mask.
+ *
+ * @return Zobrist key per castling rights mask.
+ */
+constexpr std::array<uint64_t, ALL_CASTLING + 1>
+generateZobristCastlingKeys(void) {
+  std::array<uint64_t, ALL_CASTLING + 1> keys = {};
+  for (uint8_t rights = 0; rights <= ALL_CASTLING; rights++) {
+    for (uint8_t i = 0; i < 4; i++) {
+      if (rights & (1 << i)) {
+        keys[rights] ^= zobrist_keys[ZOBRIST_CASTLING + i];
+      }
     }
-    if (enemy_player.rook & final) {
-      enemy_player.rook &= ~final;
-      if (final & (white_to_move ? BLACK_ROOK_STARTING_POSITION_KINGSIDE
-                                 : WHITE_ROOK_STARTING_POSITION_KINGSIDE)) {
-        enemy_player.can_king_side_castle = false;
-      } else if (final &
-                 (white_to_move ? BLACK_ROOK_STARTING_POSITION_QUEENSIDE
-                                : WHITE_ROOK_STARTING_POSITION_QUEENSIDE)) {
-        enemy_player.can_queen_side_castle = false;
+  }
+  return keys;
+}
+
+constexpr std::array<uint64_t, ALL_CASTLING + 1> zobrist_castling_keys =
+    generateZobristCastlingKeys();
+
+uint64_t getPositionHash(const GameState &game_state) {
+  uint64_t hash = 0;
+  uint64_t OCCUPIED = game_state.occupied;
+  while (OCCUPIED) {
+    uint8_t square = getSetBit(getLowestSetBitValue(OCCUPIED));
+    Piece piece = game_state.board[square];
+    uint8_t key = getPieceColor(piece) * 6 + getPieceType(piece);
+    hash ^= zobrist_keys[key * N_SQUARES + square];
+    clearLowestSetBit(OCCUPIED);
+  }
+  if (game_state.side_to_move == BLACK) {
+    hash ^= zobrist_keys[ZOBRIST_SIDE];
+  }
+  hash ^= zobrist_castling_keys[game_state.castling_rights];
+  if (game_state.en_passant >= 0) {
+    hash ^= zobrist_keys[ZOBRIST_EN_PASSANT + game_state.en_passant % 8];
+  }
+  return hash;
+}
+
+void populateBoard(GameState &game_state) {
+  for (uint8_t square = 0; square < N_SQUARES; square++) {
+    game_state.board[square] = NO_PIECE;
+  }
+  game_state.occupied = 0;
+  for (uint8_t color = WHITE; color < N_COLORS; color++) {
+    game_state.occupancy[color] = 0;
+    for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+      uint64_t bb = game_state.pieces[color][piece_type];
+      game_state.occupancy[color] |= bb;
+      while (bb) {
+        game_state.board[getSetBit(getLowestSetBitValue(bb))] =
+            makePiece((Color)color, (PieceType)piece_type);
+        clearLowestSetBit(bb);
       }
-      return;
     }
+    game_state.occupied |= game_state.occupancy[color];
   }
-  uint64_t E_P = getEnPassantBitboard(en_passant);
-  if ((E_P & final) && (P & initial)) {
-    enemy_player.pawn &= (white_to_move ? ~(final >> 8) : ~(final << 8));
+}
+
+/** Returns the castling rights kept when a piece moves from or to each square:
+ * all of them, except those of a king or rook starting square.
+ *
+ * @return Castling rights kept per square.
+ */
+constexpr std::array<uint8_t, N_SQUARES> generateCastlingRightsKept(void) {
+  std::array<uint8_t, N_SQUARES> kept = {};
+  for (uint8_t square = 0; square < N_SQUARES; square++) {
+    kept[square] = ALL_CASTLING;
+  }
+  kept[0] &= ~WHITE_QUEEN_SIDE;
+  kept[4] &= ~(WHITE_KING_SIDE | WHITE_QUEEN_SIDE);
+  kept[7] &= ~WHITE_KING_SIDE;
+  kept[56] &= ~BLACK_QUEEN_SIDE;
+  kept[60] &= ~(BLACK_KING_SIDE | BLACK_QUEEN_SIDE);
+  kept[63] &= ~BLACK_KING_SIDE;
+  return kept;
+}
+
+constexpr std::array<uint8_t, N_SQUARES> castling_rights_kept =
+    generateCastlingRightsKept();
+
+/** Removes the captured piece from the enemy player's bitboards and the board.
+ * Only called for capture moves: if the final square is empty, the capture is
+ * en passant.
+ *
+ * @param game_state: Game state.
+ * @param enemy: Enemy player's color.
+ * @param to: Final square of the moving piece.
+ */
+void handleCapturedPiece(GameState &game_state, Color enemy, uint8_t to) {
+  uint8_t square = to;
+  if (game_state.board[to] == NO_PIECE) {
+    square = enemy == BLACK ? to - 8 : to + 8;
+  }
+  // Only reachable from an inconsistent en passant state, but indexing the
+  // bitboards with NO_PIECE would write past them.
+  if (game_state.board[square] == NO_PIECE) {
     return;
   }
+  const PieceType piece_type = getPieceType(game_state.board[square]);
+  const uint64_t bb = 1ULL << square;
+  game_state.pieces[enemy][piece_type] &= ~bb;
+  game_state.occupancy[enemy] &= ~bb;
+  game_state.occupied &= ~bb;
+  game_state.board[square] = NO_PIECE;
+}
+
+/** Moves a piece of the active player, on its bitboards and the board.
+ *
+ * @param game_state: Game state.
+ * @param color: Active player's color.
+ * @param from: Initial square of the piece.
+ * @param to: Final square of the piece.
+ */
+void movePiece(GameState &game_state, Color color, uint8_t from, uint8_t to) {
+  const Piece piece = game_state.board[from];
+  const uint64_t from_to = (1ULL << from) | (1ULL << to);
+  game_state.pieces[color][getPieceType(piece)] ^= from_to;
+  game_state.occupancy[color] ^= from_to;
+  game_state.occupied ^= from_to;
+  game_state.board[to] = piece;
+  game_state.board[from] = NO_PIECE;
 }
 
 /** Updates the game state with the respective moved piece.
  *
- * @param white_to_move: Flag that denotes turn.
- * @param active_player: Active player's state.
- * @param en_passant: The en passant bit, if applicable.
- * @param initial: Bitboard of the moving piece, pre-move.
- * @param final: Bitboard of the moving piece, post-move.
+ * @param game_state: Game state.
+ * @param color: Active player's color.
+ * @param from: Initial square of the moving piece.
+ * @param to: Final square of the moving piece.
  * @param move_type: Move type, if applicable.
  */
-void realizeMovedPiece(bool white_to_move, ColorState &active_player,
-                       int8_t &en_passant, uint64_t initial, uint64_t final,
-                       MoveType move_type) {
+void realizeMovedPiece(GameState &game_state, Color color, uint8_t from,
+                       uint8_t to, MoveType move_type) {
+  movePiece(game_state, color, from, to);
+  game_state.en_passant = -1;
+
   switch (move_type) {
   case NONE:
-    if (active_player.queen & initial) {
-      active_player.queen |= final;
-      active_player.queen &= ~initial;
-    } else if (active_player.bishop & initial) {
-      active_player.bishop |= final;
-      active_player.bishop &= ~initial;
-    } else if (active_player.knight & initial) {
-      active_player.knight |= final;
-      active_player.knight &= ~initial;
-    } else if (active_player.pawn & initial) {
-      active_player.pawn |= final;
-      active_player.pawn &= ~initial;
-    } else if (active_player.king & initial) {
-      active_player.can_king_side_castle = false;
-      active_player.can_queen_side_castle = false;
-      active_player.king = final;
-    } else if (active_player.rook & initial) {
-      if (initial & (white_to_move ? WHITE_ROOK_STARTING_POSITION_KINGSIDE
-                                   : BLACK_ROOK_STARTING_POSITION_KINGSIDE)) {
-        active_player.can_king_side_castle = false;
-      } else if (initial &
-                 (white_to_move ? WHITE_ROOK_STARTING_POSITION_QUEENSIDE
-                                : BLACK_ROOK_STARTING_POSITION_QUEENSIDE)) {
-        active_player.can_queen_side_castle = false;
-      }
-      active_player.rook |= final;
-      active_player.rook &= ~initial;
-    }
-    en_passant = -1;
     return;
   case CASTLE_KINGSIDE:
-    active_player.king <<= 2;
-    active_player.rook |= white_to_move
-                              ? WHITE_ROOK_POST_KINGSIDE_CASTLE_POSITION
-                              : BLACK_ROOK_POST_KINGSIDE_CASTLE_POSITION;
-    active_player.rook &= white_to_move
-                              ? ~WHITE_ROOK_STARTING_POSITION_KINGSIDE
-                              : ~BLACK_ROOK_STARTING_POSITION_KINGSIDE;
-    active_player.can_king_side_castle = false;
-    active_player.can_queen_side_castle = false;
-    en_passant = -1;
+    movePiece(game_state, color, to + 1, to - 1);
     return;
   case CASTLE_QUEENSIDE:
-    active_player.king >>= 2;
-    active_player.rook |= white_to_move
-                              ? WHITE_ROOK_POST_QUEENSIDE_CASTLE_POSITION
-                              : BLACK_ROOK_POST_QUEENSIDE_CASTLE_POSITION;
-    active_player.rook &= white_to_move
-                              ? ~WHITE_ROOK_STARTING_POSITION_QUEENSIDE
-                              : ~BLACK_ROOK_STARTING_POSITION_QUEENSIDE;
-    active_player.can_king_side_castle = false;
-    active_player.can_queen_side_castle = false;
-    en_passant = -1;
+    movePiece(game_state, color, to - 2, to + 1);
     return;
   case PROMOTION_QUEEN:
-    active_player.pawn &= ~initial;
-    active_player.queen |= final;
-    en_passant = -1;
-    return;
   case PROMOTION_ROOK:
-    active_player.pawn &= ~initial;
-    active_player.rook |= final;
-    en_passant = -1;
-    return;
-  case PROMOTION_BISHOP:
-    active_player.pawn &= ~initial;
-    active_player.bishop |= final;
-    en_passant = -1;
-    return;
   case PROMOTION_KNIGHT:
-    active_player.pawn &= ~initial;
-    active_player.knight |= final;
-    en_passant = -1;
+  case PROMOTION_BISHOP: {
+    const PieceType piece_types[4] = {QUEEN, ROOK, KNIGHT, BISHOP};
+    const PieceType piece_type = piece_types[move_type - PROMOTION_QUEEN];
+    game_state.pieces[color][PAWN] &= ~(1ULL << to);
+    game_state.pieces[color][piece_type] |= 1ULL << to;
+    game_state.board[to] = makePiece(color, piece_type);
     return;
-  // case EN_PASSANT:
-  //   active_player.pawn |= final;
-  //   active_player.pawn &= ~initial;
-  //   en_passant = -1;
-  //   return;
+  }
   case PAWN_PUSH_2:
-    active_player.pawn |= final;
-    active_player.pawn &= ~initial;
-    en_passant = white_to_move ? getSetBit(final >> 8) : getSetBit(final << 8);
+    game_state.en_passant = (from + to) / 2;
     return;
   default:
     logErrorAndExit("ERROR: Unexpected move_type value!");
@@ -389,46 +489,22 @@ void realizeMovedPiece(bool white_to_move, ColorState &active_player,
   }
 }
 
-/** Applies the white player's move.
- *
- * @param game_state: Game state.
- * @param move: Move.
- * @param initial: Bitboard of the moving piece, pre-move.
- * @param final: Bitboard of the moving piece, post-move.
- * @param move_type: Move type, if applicable.
- */
-void applyWhiteMove(GameState &game_state, const Move &move, uint64_t initial,
-                    uint64_t final, MoveType move_type) {
-  handleCapturedPiece(game_state.whites_turn, game_state.white.pawn,
-                      game_state.black, game_state.en_passant, initial, final);
-  realizeMovedPiece(game_state.whites_turn, game_state.white,
-                    game_state.en_passant, initial, final, move_type);
-}
-
-/** Applies the black player's move.
- *
- * @param game_state: Game state.
- * @param move: Move.
- * @param initial: Bitboard of the moving piece, pre-move.
- * @param final: Bitboard of the moving piece, post-move.
- * @param move_type: Move type, if applicable.
- */
-void applyBlackMove(GameState &game_state, const Move &move, uint64_t initial,
-                    uint64_t final, MoveType move_type) {
-  handleCapturedPiece(game_state.whites_turn, game_state.black.pawn,
-                      game_state.white, game_state.en_passant, initial, final);
-  realizeMovedPiece(game_state.whites_turn, game_state.black,
-                    game_state.en_passant, initial, final, move_type);
-}
-
 void applyMove(Move move, GameState &game_state) {
-  const uint64_t initial = move.getInitialBitboard();
-  const uint64_t final = move.getFinalBitboard();
-  const MoveType move_type = move.getMoveType();
-  if (game_state.whites_turn) {
-    applyWhiteMove(game_state, move, initial, final, move_type);
-  } else {
-    applyBlackMove(game_state, move, initial, final, move_type);
-  }
-  game_state.whites_turn = !game_state.whites_turn;
+  const Color color = game_state.getActiveColor();
+  if (move.isCapture() ||
+      getPieceType(game_state.board[move.getFrom()]) == PAWN) {
+    game_state.halfmove_clock = 0;
+  } else if (game_state.halfmove_clock < UINT16_MAX) {
+    game_state.halfmove_clock++;
+  }
+  game_state.fullmove_number += color == BLACK;
+  if (move.isCapture()) {
+    handleCapturedPiece(game_state, Color(color ^ 1), move.getTo());
+  }
+  game_state.castling_rights &= castling_rights_kept[move.getFrom()] &
+                                castling_rights_kept[move.getTo()];
+  realizeMovedPiece(game_state, color, move.getFrom(), move.getTo(),
+                    move.getMoveType());
+  game_state.side_to_move = Color(color ^ 1);
+  updateCheckState(game_state);
 }
@@ -1,59 +1,142 @@
 #pragma once
 
+#include "constants.h"
 #include "move.h"
 #include <stdint.h>
 #include <string>
+#include <string_view>
 
-class ColorState {
+// Laid out to fill exactly 4 cache lines when copied: the mailbox board
+// first, then the bitboards, then the small fields packed at the end.
+class alignas(64) GameState {
 public:
-  uint64_t rook = 0;
-  uint64_t knight = 0;
-  uint64_t bishop = 0;
-  uint64_t queen = 0;
-  uint64_t king = 0;
-  uint64_t pawn = 0;
-  bool can_king_side_castle = false;
-  bool can_queen_side_castle = false;
-
-  uint64_t getOccupiedBitboard(void) {
-    return pawn | rook | knight | bishop | queen | king;
-  }
-};
+  // Piece on each square, kept in sync with the bitboards by applyMove().
+  Piece board[N_SQUARES] = {};
 
-class GameState {
-public:
-  // State of the white pieces.
-  ColorState white;
+  // Bitboard of each piece type of each color.
+  uint64_t pieces[N_COLORS][N_PIECE_TYPES] = {};
+
+  // Squares occupied by each color, and by both colors. Kept in sync with the
+  // piece bitboards by applyMove().
+  uint64_t occupancy[N_COLORS] = {};
+  uint64_t occupied = 0;
+
+  // Enemy pieces giving check to the active player, and the active player's
+  // pieces pinned to its king. Kept up to date by applyMove().
+  uint64_t checkers = 0;
+  uint64_t pinned = 0;
 
-  // State of the black pieces.
-  ColorState black;
+  // Plies since the last capture or pawn move, and the move number, which
+  // starts at 1 and is incremented after black's move.
+  uint16_t halfmove_clock = 0;
+  uint16_t fullmove_number = 1;
 
-  // If true -> white's turn, false -> black's turn.
-  bool whites_turn = true;
+  // Castling rights of both colors, as a mask of CastlingRights bits.
+  uint8_t castling_rights = NO_CASTLING;
+
+  Color side_to_move = WHITE;
 
   // The bit of the possible en passant. -1 denotes no en passant available.
   int8_t en_passant = -1;
 
-  uint64_t getWhiteOccupiedBitboard(void) {
-    return white.getOccupiedBitboard();
+  Color getActiveColor(void) const { return side_to_move; }
+
+  bool canKingSideCastle(Color color) const {
+    return castling_rights & getKingSideCastlingRight(color);
   }
-  uint64_t getBlackOccupiedBitboard(void) {
-    return black.getOccupiedBitboard();
+
+  bool canQueenSideCastle(Color color) const {
+    return castling_rights & getQueenSideCastlingRight(color);
   }
 };
 
+static_assert(sizeof(GameState) == 4 * 64,
+              "GameState is expected to fill 4 cache lines.");
+
 /** Prints board to std out.
  *
  * @param game_state: Game state.
  */
 void printBoard(const GameState &game_state);
 
-/** Converts a FEN string to a game state.
+enum FenError : uint8_t {
+  FEN_OK = 0,
+  FEN_MISSING_FIELD = 1,
+  FEN_INVALID_BOARD = 2,
+  FEN_INVALID_PIECE_COUNT = 3,
+  FEN_INVALID_SIDE_TO_MOVE = 4,
+  FEN_INVALID_CASTLING = 5,
+  FEN_INVALID_EN_PASSANT = 6,
+  FEN_INVALID_MOVE_COUNTER = 7,
+  FEN_TRAILING_INPUT = 8
+};
+
+/** Returns a description of the FEN error.
+ *
+ * @param error: FEN error.
+ * @return Description.
+ */
+const char *fenErrorToString(FenError error);
+
+/** Checks that the number of pieces of each color is possible: 1 king, at most
+ * 8 pawns, and no more promoted pieces than missing pawns.
+ *
+ * @param game_state: Game state.
+ * @return True if the piece counts are possible.
+ */
+bool hasPossiblePieceCounts(const GameState &game_state);
+
+/** Drops the castling rights whose king or rook is not on its starting
+ * square.
+ *
+ * @param game_state: Game state.
+ */
+void dropImpossibleCastlingRights(GameState &game_state);
+
+/** Checks that the en passant square is possible for the side to move: behind
+ * an enemy pawn that just moved 2 squares, with the square and the pawn's
+ * starting square empty.
+ *
+ * @param game_state: Game state, with its piece bitboards populated.
+ * @param square: En passant square.
+ * @return True if the en passant square is possible.
+ */
+bool isPossibleEnPassant(const GameState &game_state, uint8_t square);
+
+/** Converts a FEN string to a game state, in a single pass without
+ * allocating. The halfmove clock and fullmove number fields are optional.
+ * Castling rights without the king and rook on their starting squares are
+ * dropped.
  *
  * @param fen: FEN string.
+ * @param game_state: Game state, only populated if the FEN is valid.
+ * @return FEN_OK, or the first error found.
+ */
+FenError fenToGameState(std::string_view fen, GameState &game_state);
+
+/** Returns the length of the FEN at the start of the line: the first 4
+ * fields, followed by the move counters if present. Splits a FEN from the text
+ * that follows it, such as a game result.
+ *
+ * @param line: Line starting with a FEN.
+ * @return Length of the FEN.
+ */
+size_t getFenLength(std::string_view line);
+
+/** Returns the Zobrist hash of the position: the pieces, the side to move, the
+ * castling rights and the en passant file.
+ *
+ * @param game_state: Game state.
+ * @return Hash of the position.
+ */
+uint64_t getPositionHash(const GameState &game_state);
+
+/** Fills the occupancy bitboards and the mailbox board from the piece
+ * bitboards.
+ *
  * @param game_state: Game state.
  */
-void fenToGameState(const std::string fen, GameState &game_state);
+void populateBoard(GameState &game_state);
 
 /** Updates the game state according to the move.
  *
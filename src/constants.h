@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <stdint.h>
 #include <string>
 
@@ -87,6 +88,50 @@ const uint64_t diagonal_f1h3 = 0x804020;
 const uint64_t diagonal_g1h2 = 0x8040;
 const uint64_t diagonal_h1 = 0x80;
 
+enum Color : uint8_t { WHITE = 0, BLACK = 1, N_COLORS = 2 };
+
+// Castling rights, as the bits of a 4-bit mask.
+enum CastlingRights : uint8_t {
+  NO_CASTLING = 0,
+  WHITE_KING_SIDE = 1,
+  WHITE_QUEEN_SIDE = 2,
+  BLACK_KING_SIDE = 4,
+  BLACK_QUEEN_SIDE = 8,
+  ALL_CASTLING = 15
+};
+
+constexpr uint8_t getKingSideCastlingRight(Color color) {
+  return WHITE_KING_SIDE << (color * 2);
+}
+
+constexpr uint8_t getQueenSideCastlingRight(Color color) {
+  return WHITE_QUEEN_SIDE << (color * 2);
+}
+
+enum PieceType : uint8_t {
+  PAWN = 0,
+  KNIGHT = 1,
+  BISHOP = 2,
+  ROOK = 3,
+  QUEEN = 4,
+  KING = 5,
+  N_PIECE_TYPES = 6
+};
+
+// Contents of a square of the mailbox board. 0 if empty, otherwise the piece
+// type + 1 in bits 0 - 2 and the color in bit 3.
+enum Piece : uint8_t { NO_PIECE = 0 };
+
+constexpr Piece makePiece(Color color, PieceType piece_type) {
+  return Piece(color << 3 | (piece_type + 1));
+}
+
+constexpr PieceType getPieceType(Piece piece) {
+  return PieceType((piece & 7) - 1);
+}
+
+constexpr Color getPieceColor(Piece piece) { return Color(piece >> 3); }
+
 enum directional_indices {
   RANKS = 0,
   FILES = 1,
@@ -96,7 +141,7 @@ enum directional_indices {
 };
 
 // Stores the horizontal, vertical, and diagonal masks for each square.
-const uint64_t directional_mask[N_SQUARES][N_DIRECTIONS] = {
+constexpr uint64_t directional_mask[N_SQUARES][N_DIRECTIONS] = {
     {rank_1, file_a, diagonal_a1, diagonal_a1h8},
     {rank_1, file_b, diagonal_a2b1, diagonal_b1h7},
     {rank_1, file_c, diagonal_a3c1, diagonal_c1h6},
@@ -162,12 +207,44 @@ const uint64_t directional_mask[N_SQUARES][N_DIRECTIONS] = {
     {rank_8, file_g, diagonal_g8h7, diagonal_a2g8},
     {rank_8, file_h, diagonal_h8, diagonal_a1h8}};
 
-const uint8_t N_BISHOP_BLOCKERS = 9;
-const uint8_t N_ROOK_BLOCKERS = 12;
-const uint16_t N_BISHOP_BLOCKERS_PERMUTATIONS = 1 << N_BISHOP_BLOCKERS;
-const uint16_t N_ROOK_BLOCKERS_PERMUTATIONS = 1 << N_ROOK_BLOCKERS;
+/** Generates the line or between masks of every pair of squares.
+ *
+ * @param between: If true, only the squares strictly between the two squares,
+ * else the whole rank/file/diagonal through both.
+ * @return Masks, indexed by both squares. 0 if the squares are not on a common
+ * rank/file/diagonal.
+ */
+constexpr std::array<std::array<uint64_t, N_SQUARES>, N_SQUARES>
+generateLineMasks(bool between) {
+  std::array<std::array<uint64_t, N_SQUARES>, N_SQUARES> masks{};
+  for (uint8_t bit_1 = 0; bit_1 < N_SQUARES; bit_1++) {
+    for (uint8_t bit_2 = 0; bit_2 < N_SQUARES; bit_2++) {
+      for (uint8_t dir = 0; dir < N_DIRECTIONS && bit_1 != bit_2; dir++) {
+        if (directional_mask[bit_1][dir] != directional_mask[bit_2][dir]) {
+          continue;
+        }
+        uint8_t low = bit_1 < bit_2 ? bit_1 : bit_2;
+        uint8_t high = bit_1 < bit_2 ? bit_2 : bit_1;
+        uint64_t between_bits = (1ULL << high) - (2ULL << low);
+        masks[bit_1][bit_2] = directional_mask[bit_1][dir] &
+                              (between ? between_bits : FILLED);
+      }
+    }
+  }
+  return masks;
+}
+
+// The rank/file/diagonal through two squares (including them), indexed by both
+// squares. 0 if they are not on a common line.
+inline constexpr std::array<std::array<uint64_t, N_SQUARES>, N_SQUARES>
+    line_mask = generateLineMasks(false);
 
-const uint64_t bishop_magic_masks[N_SQUARES] = {
+// The squares strictly between two squares on a common rank/file/diagonal,
+// indexed by both squares. 0 if they are not on a common line.
+inline constexpr std::array<std::array<uint64_t, N_SQUARES>, N_SQUARES>
+    between_mask = generateLineMasks(true);
+
+constexpr uint64_t bishop_magic_masks[N_SQUARES] = {
     0x40201008040200, 0x402010080400,   0x4020100A00,     0x40221400,
     0x2442800,        0x204085000,      0x20408102000,    0x2040810204000,
     0x20100804020000, 0x40201008040000, 0x4020100A0000,   0x4022140000,
@@ -185,33 +262,37 @@ const uint64_t bishop_magic_masks[N_SQUARES] = {
     0x2040810204000,  0x4081020400000,  0xA102040000000,  0x14224000000000,
     0x28440200000000, 0x50080402000000, 0x20100804020000, 0x40201008040200};
 
-const uint64_t bishop_magic_numbers[N_SQUARES] = {
-    0x6110003449004200, 0x808100824410410,  0x482280011881802,
-    0x801230002008400,  0x8048208800000001, 0x420040A090200800,
-    0x1000820800822300, 0x1100028058A01040, 0x320004808293012,
-    0x4440402C9050,     0x92100042000D00,   0x8002841800326,
-    0x400010882014002,  0xA00D8020020021,   0x289001048005000,
-    0x8010141014100208, 0x6000440808C2A,    0x40402000820C2102,
-    0x40082080088C,     0x12A210104000400,  0x298400200000,
-    0x100222A04140180,  0x41040A0242106180, 0x1801000068801202,
-    0x548583102002108,  0x200008012310,     0x240980020820004,
-    0x3020080010820440, 0x201001001004001,  0x40403002011008,
-    0x2002800882482101, 0x10040050C00C4201, 0x8804100400808380,
-    0x8063010E10020,    0x66005047208D01,   0x4001040400080210,
-    0x4140002020020080, 0x9000825461001000, 0x212215440020,
-    0x13401004100200,   0x8C0A0A010C0242,   0xC222240842000808,
-    0x4A00020850212860, 0x1802400200100,    0x80008100821C100,
-    0x8840110021000209, 0x200600A801020010, 0x122888905000002,
-    0x2000241001180000, 0x5070188440600201, 0x4100028010084008,
-    0xAE02000C14041048, 0x890002E60402400,  0x210482001181400,
-    0x408800146010,     0x80020220E2820002, 0x4650140020140200,
-    0x11249D00110,      0x706A508040A01,    0x288002082008B0,
-    0x100000040040820,  0x40002088010044,   0x3A0090001600,
-    0x200610A00052D};
+// Used for bishop magic bitboards move lookup. Each square uses as many index
+// bits as it has relevant blockers. Generated by "venus_chess magics".
+// clang-format off
+constexpr uint64_t bishop_magic_numbers[N_SQUARES] = {
+    0x4C4380860440140, 0x2002020A0C2000, 0x8021021400402002,
+    0x8004242280404200, 0x804030800108200, 0x2001040240080080,
+    0x1040104400808, 0x84808800900444, 0x1200100411980200,
+    0xB01080908480, 0x5088081020090, 0x1091041C21828802,
+    0x4020210240020, 0x3081011002101580, 0x1500408824100408,
+    0x2420020100880540, 0x860904002840122, 0x8022003110021082,
+    0x2042001004001820, 0x4A0800A402102440, 0x884000A00940008,
+    0x912006022100200, 0x411044200822000, 0x2012101092100,
+    0xA0840808080800, 0x204022004080801, 0x1118020001020200,
+    0x22008028008002, 0x2001001021004000, 0x4000820181004216,
+    0x209122008C1000, 0xC04206A0808400, 0xA01082000082001,
+    0x449043088421004, 0x2000180600240C00, 0xB200800030811,
+    0x80840040101C0100, 0x8012080600204040, 0x808880040010100,
+    0x18309282010040, 0x428040484066080, 0x6202085404500200,
+    0x2400824240420800, 0x820400D148003400, 0x4240200410404C00,
+    0x81116180A010040, 0xC60084604A00040, 0x28102020A000049,
+    0x400480842021C040, 0x2020124421984, 0x4100410088041048,
+    0x40800084040400, 0x8200011002020416, 0x5480810010A0A11,
+    0x10101148428000, 0xA002840802004040, 0x2020622020210,
+    0x228048280401, 0x102500044041122, 0x4421100400420880,
+    0x2803001C04104414, 0x2453012108104, 0x210C00508120441,
+    0x3040010400820040};
+// clang-format on
 
 // Masks that include both horizontal and vertical lines, excluding outer
 // squares and the repective bit. Used for doing magic calculations.
-const uint64_t rook_magic_masks[N_SQUARES] = {
+constexpr uint64_t rook_magic_masks[N_SQUARES] = {
     0x101010101017E,    0x202020202027C,    0x404040404047A,
     0x8080808080876,    0x1010101010106E,   0x2020202020205E,
     0x4040404040403E,   0x8080808080807E,   0x1010101017E00,
@@ -269,23 +350,29 @@ const uint64_t king_moves[N_SQUARES] = {0x302, 0x705, 0xE0A, 0x1C14, 0x3828,
   0x141C000000000000, 0x2838000000000000, 0x5070000000000000, 
   0xA0E0000000000000, 0x40C0000000000000};
 
-// Used for rook magic bitboards move lookup.
-const uint64_t rook_magic_numbers[N_SQUARES] = {0x5080008020400014,
-  0x6004012000081100, 0x8800A8020001001, 0x200024005920020,  
-  0x8A000216011A0008, 0x8024010482000400, 0x48008008020122,   
-  0x100025225000086, 0x9080080C80204100, 0x140020024003, 0x2080008114080, 
-  0x1001702009001001, 0x4000180402100100, 0x148040008140, 0x202101008240440,
-  0x400900804C00020, 0x8004880010048, 0x80106000204000, 0x806001102208014,
-  0x94020C800040008, 0x8000604801080082, 0x108022008208900, 0x14102E021030, 
-  0x2A000410001, 0x20012008001004, 0x400028040848, 0x80880404046058, 
-  0x98400420022030, 0x208200011004, 0x1000804060020020, 0x200060806002004, 
-  0x400024820110182, 0x40081020800080, 0x80081405200A010C, 0x81100801020020, 
-  0x220200201340404, 0x4200080040500548, 0x80040001002000A0, 0x2200140081104,
-  0x111010074821148, 0xA050088100100400, 0x890022101012, 0x40100290584800, 
-  0x21100004601100, 0x4000408224011, 0x9008320011, 0x200008511002042, 
-  0x20808020410002, 0x80002400400848, 0x40811028220010, 0x280104009200100,
-  0x9088010004800210, 0x108090521005050, 0x120054002080, 0xA0800CA202004100, 
-  0x5200916800444, 0x30A081C2010812, 0x202008008204902, 0x2040902100094441, 
-  0x4004184200041002, 0x3000210010082183, 0x18104900040001C1, 
-  0x304081000810044, 0x2290010424009142};
+// Used for rook magic bitboards move lookup. Each square uses as many index
+// bits as it has relevant blockers. Generated by "venus_chess magics".
+constexpr uint64_t rook_magic_numbers[N_SQUARES] = {
+    0x8080102040008000, 0x5440041000200048, 0x8020008010000A,
+    0x200084200100420, 0x200081020040200, 0x600019002002824,
+    0x40050811008020C, 0x100004881000126, 0x5800440008020,
+    0x2882002042090880, 0x2802000801004, 0x240808010000800,
+    0x4480800800040082, 0x408808004000200, 0xBA0004A8020001,
+    0x1106000042040091, 0x20208010400080, 0x22060045028020,
+    0x20008020100080, 0x202020008102041, 0xC50808008000400,
+    0x68808002000400, 0x510400C8100201, 0x400006000100A444,
+    0x483424818008400A, 0x8840008080200040, 0x800100080802000,
+    0x440100080800800, 0x4000080080040080, 0x9124040080020080,
+    0x89000300040E00, 0x80001020020488C, 0x9040002040800080,
+    0x80D0002001400242, 0x401901002002, 0x30220901001000,
+    0x80580005003100, 0x22006C0A001008, 0x802301144001248,
+    0x20010042000084, 0x4AC0400084228004, 0x10004020004000,
+    0x3110004020010100, 0x598100009050020, 0x4200080011010004,
+    0x818020004008080, 0x2A0708102040008, 0x5201010080420004,
+    0x100B124063800100, 0x7808200240048980, 0x8800200010008080,
+    0x1099201001000900, 0x100050010080100, 0x400800200040080,
+    0x2040280190020400, 0x100C0100608200, 0x201241088202,
+    0x1040002042801B01, 0x124090010200041, 0x831002004081001,
+    0x2003000800021005, 0x80010002040008C1, 0x208008122081004,
+    0x4000008844002102};
 // clang-format on
@@ -0,0 +1,186 @@
+#include "epd.h"
+#include "board.h"
+#include "helper_functions.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+MappedFile::MappedFile(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == 0) {
+    // Empty files can't be mapped, but are valid.
+    is_open = info.st_size == 0;
+    void *mapping = info.st_size ? mmap(nullptr, info.st_size, PROT_READ,
+                                        MAP_PRIVATE, fd, 0)
+                                 : MAP_FAILED;
+    if (mapping != MAP_FAILED) {
+      madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+      data = (const char *)mapping;
+      size = info.st_size;
+      is_open = true;
+    }
+  }
+  // The mapping stays valid after the file is closed.
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data) {
+    munmap((void *)data, size);
+  }
+}
+
+/** Removes the leading and trailing whitespace of the text.
+ *
+ * @param text: Text.
+ * @return Trimmed text.
+ */
+std::string_view trimWhitespace(std::string_view text) {
+  size_t begin = text.find_first_not_of(" \t\r\n");
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+  size_t end = text.find_last_not_of(" \t\r\n");
+  return text.substr(begin, end - begin + 1);
+}
+
+void parseEpdOperations(std::string_view text, EpdPosition &position) {
+  size_t pos = 0;
+  while (pos < text.size()) {
+    std::string_view opcode = getNextToken(text, pos);
+    if (opcode.empty()) {
+      return;
+    }
+    // An operation without operands ends with the opcode, e.g. `noop;`.
+    if (opcode.back() == ';') {
+      continue;
+    }
+
+    // Operands run up to the semicolon, which may be quoted in a string.
+    size_t begin = pos;
+    bool quoted = false;
+    while (pos < text.size() && (quoted || text[pos] != ';')) {
+      quoted ^= text[pos] == '"';
+      pos++;
+    }
+    std::string_view operands = trimWhitespace(text.substr(begin, pos - begin));
+    pos++;
+    if (operands.size() >= 2 && operands.front() == '"' &&
+        operands.back() == '"') {
+      operands = operands.substr(1, operands.size() - 2);
+    }
+
+    if (opcode == "bm") {
+      position.best_moves = operands;
+    } else if (opcode == "id") {
+      position.id = operands;
+    } else if (opcode == "c0") {
+      position.comment = operands;
+    } else if (opcode == "acd") {
+      position.analysis_depth = operands;
+    }
+  }
+}
+
+/** Parses a line of an EPD file.
+ *
+ * @param line: Line.
+ * @param position: Position, only populated if the line is valid.
+ * @return False if the line is not a valid position.
+ */
+bool parseEpdLine(std::string_view line, EpdPosition &position) {
+  size_t fen_length = getFenLength(line);
+  if (!fen_length || fenToGameState(line.substr(0, fen_length),
+                                    position.game_state) != FEN_OK) {
+    return false;
+  }
+  parseEpdOperations(line.substr(fen_length), position);
+  return true;
+}
+
+/** Counts the lines of the text, including a last line without a newline.
+ *
+ * @param text: Text.
+ * @return Number of lines.
+ */
+size_t countLines(std::string_view text) {
+  return std::count(text.begin(), text.end(), '\n') +
+         (!text.empty() && text.back() != '\n');
+}
+
+EpdFile::EpdFile(const std::string &path) : file(path) {
+  std::string_view text = file.getText();
+
+  // Splits the text into a range of lines per thread.
+  const uint32_t n_ranges = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<size_t> range_starts(n_ranges + 1, text.size());
+  range_starts[0] = 0;
+  for (uint32_t i = 1; i < n_ranges; i++) {
+    size_t newline = text.find('\n', text.size() * i / n_ranges);
+    range_starts[i] = std::max(
+        range_starts[i - 1],
+        newline == std::string_view::npos ? text.size() : newline + 1);
+  }
+  auto getRange = [&](uint32_t i) {
+    return text.substr(range_starts[i], range_starts[i + 1] - range_starts[i]);
+  };
+
+  // Each range is parsed into its own slice of the array, sized by counting
+  // the lines first.
+  std::vector<size_t> offsets(n_ranges + 1, 0);
+  runInParallel(n_ranges, [&](uint32_t, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      offsets[i + 1] = countLines(getRange(i));
+    }
+  });
+  for (uint32_t i = 0; i < n_ranges; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+  positions.resize(offsets[n_ranges]);
+
+  std::vector<size_t> n_parsed(n_ranges, 0);
+  std::vector<uint64_t> n_range_invalid(n_ranges, 0);
+  runInParallel(n_ranges, [&](uint32_t, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; i++) {
+      std::string_view range = getRange(i);
+      EpdPosition *next = positions.data() + offsets[i];
+      for (size_t start = 0; start < range.size();) {
+        size_t newline = range.find('\n', start);
+        newline = newline == std::string_view::npos ? range.size() : newline;
+        std::string_view line = range.substr(start, newline - start);
+        start = newline + 1;
+        if (trimWhitespace(line).empty()) {
+          continue;
+        }
+        if (parseEpdLine(line, *next)) {
+          next++;
+        } else {
+          n_range_invalid[i]++;
+        }
+      }
+      n_parsed[i] = next - (positions.data() + offsets[i]);
+    }
+  });
+
+  // Closes the gaps left by invalid and blank lines.
+  size_t n_positions = 0;
+  for (uint32_t i = 0; i < n_ranges; i++) {
+    // std::move does not allow the destination to start inside the source.
+    if (n_positions != offsets[i]) {
+      std::move(positions.begin() + offsets[i],
+                positions.begin() + offsets[i] + n_parsed[i],
+                positions.begin() + n_positions);
+    }
+    n_positions += n_parsed[i];
+    n_invalid += n_range_invalid[i];
+  }
+  positions.resize(n_positions);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "board.h"
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** Read-only memory mapping of a whole file. */
+class MappedFile {
+public:
+  /** Maps the file.
+   *
+   * @param path: Path of the file.
+   */
+  MappedFile(const std::string &path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool isOpen(void) const { return is_open; }
+
+  /** Returns the contents of the file, valid while the file is mapped. */
+  std::string_view getText(void) const { return {data, size}; }
+
+private:
+  const char *data = nullptr;
+  size_t size = 0;
+  bool is_open = false;
+};
+
+/** A position of an EPD file. The operations are views into the mapped file,
+ * without the quotes of a string operand, and empty if absent.
+ */
+struct EpdPosition {
+  GameState game_state;
+  // Best moves (bm), identifier (id) and comment (c0).
+  std::string_view best_moves;
+  std::string_view id;
+  std::string_view comment;
+  // Analysis depth (acd), used as the search depth by the batch analysis.
+  std::string_view analysis_depth;
+};
+
+/** Splits the operations that follow the position of an EPD line, e.g.
+ * `bm Nf3; id "test.01";`, and keeps the bm, id, c0 and acd operands.
+ *
+ * @param text: Operations.
+ * @param position: Position, populated by this function.
+ */
+void parseEpdOperations(std::string_view text, EpdPosition &position);
+
+/** Positions of a memory-mapped EPD or FEN file, one per line. A line holds
+ * the first 4 FEN fields, optionally followed by the move counters, and then
+ * the EPD operations.
+ *
+ * The file is split into ranges of lines that are parsed in parallel into one
+ * preallocated array, without allocating per line.
+ */
+class EpdFile {
+public:
+  /** Maps and parses the file. Invalid lines are skipped, and blank lines are
+   * ignored.
+   *
+   * @param path: Path of the file.
+   */
+  EpdFile(const std::string &path);
+
+  bool isOpen(void) const { return file.isOpen(); }
+
+  /** Returns the positions, in the order of the file. */
+  const std::vector<EpdPosition> &getPositions(void) const {
+    return positions;
+  }
+
+  /** Returns the number of invalid lines skipped. */
+  uint64_t getInvalidCount(void) const { return n_invalid; }
+
+private:
+  MappedFile file;
+  std::vector<EpdPosition> positions;
+  uint64_t n_invalid = 0;
+};
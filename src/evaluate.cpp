@@ -1,105 +1,83 @@
+#include "evaluate.h"
 #include "board.h"
 #include "constants.h"
+#include "evaluation_parameters.h"
+#include "helper_functions.h"
+#include "move_generator.h"
+#include <algorithm>
+#include <array>
 #include <stdint.h>
 
-const int16_t PAWN_VALUE = 100;
-const int16_t KNIGHT_VALUE = 300;
-const int16_t BISHOP_VALUE = 300;
-const int16_t ROOK_VALUE = 500;
-const int16_t QUEEN_VALUE = 900;
-
-// clang-format off
-const int8_t white_pawn_position_adjustment[N_SQUARES] = {
-   0,   0,   0,   0,    0,    0,   0,   0,
-   5,   10,  10, -20,  -20,   10,  10,  5,
-   5,  -5,  -10,  0,    0,   -10, -5,   5,
-   0,   0,   0,   20,   20,   0,   0,   0,
-   5,   5,   10,  25,   25,   10,  5,   5,
-   10,  10,  20,  30,   30,   20,  10,  10,
-   50,  50,  50,  50,   50,   50,  50,  50,
-   0,   0,   0,   0,    0,    0,   0,   0,
-};
-
-const int8_t white_knight_position_adjustment[N_SQUARES] = {
-  -50, -40, -30, -30, -30, -30, -40, -50,
-  -40, -20,  0,   5,   5,   0,  -20, -40,
-  -30,  5,   10,  15,  15,  10,  5,  -30,
-  -30,  0,   15,  20,  20,  15,  0,  -30, 
-  -30,  5,   15,  20,  20,  15,  5,  -30, 
-  -30,  0,   10,  15,  15,  10,  0,  -30,
-  -40, -20,  0,   0,   0,   0,  -20, -40,
-  -50, -40, -30, -30, -30, -30, -40, -50,
-};
-
-const int8_t white_rook_position_adjustment[N_SQUARES] = {
-   0,   0,   5,   10,  10,  5,   0,   0,
-  -5,   0,   0,   0,   0,   0,   0,  -5,
-  -5,   0,   0,   0,   0,   0,   0,  -5,
-  -5,   0,   0,   0,   0,   0,   0,  -5,
-  -5,   0,   0,   0,   0,   0,   0,  -5,
-  -5,   0,   0,   0,   0,   0,   0,  -5,
-   5,   10,  10,  10,  10,  10,  10,  5,
-   0,   0,   0,   0,   0,   0,   0,   0,
-};
-
-const int8_t white_bishop_position_adjustment[N_SQUARES] = {
-  -20, -10, -10, -10, -10, -10, -10, -20,
-  -10,  5,   0,   0,   0,   0,   5,  -10,
-  -10,  10,  10,  10,  10,  10,  10, -10,
-  -10,  0,   10,  10,  10,  10,  0,  -10,
-  -10,  5,   5,   10,  10,  5,   5,  -10, 
-  -10,  0,   5,   10,  10,  5,   0,  -10,
-  -10,  0,   0,   0,   0,   0,   0,  -10,
-  -20, -10, -10, -10, -10, -10, -10, -20,
-};
-
-const int8_t white_queen_position_adjustment[N_SQUARES] = {
-  -20, -10, -10, -5,  -5,  -10, -10, -20
-  -10,  0,   5,   0,   0,   0,   0,  -10, 
-  -10,  5,   5,   5,   5,   5,   0,  -10, 
-   0,   0,   5,   5,   5,   5,   0,  -5,  
-  -5,   0,   5,   5,   5,   5,   0,  -5,
-  -10,  0,   5,   5,   5,   5,   0,  -10,
-  -10,  0,   0,   0,   0,   0,   0,  -10, 
-  -20, -10, -10, -5,  -5,  -10, -10, -20,
-};
-
-const int8_t white_king_position_adjustment[N_SQUARES] = {
-   20,  30,  10,  0,   0,   10,  30,  20,
-   20,  20,  0,   0,   0,   0,   20,  20, 
-  -10, -20, -20, -20, -20, -20, -20, -10, 
-  -20, -30, -30, -40, -40, -30, -30, -20,
-  -30, -40, -40, -50, -50, -40, -40, -30, 
-  -30, -40, -40, -50, -50, -40, -40, -30, 
-  -30, -40, -40, -50, -50, -40, -40, -30, 
-  -30, -40, -40, -50, -50, -40, -40, -30,
-};
-// clang-format on
-
-int8_t black_pawn_position_adjustment[N_SQUARES];
-int8_t black_knight_position_adjustment[N_SQUARES];
-int8_t black_rook_position_adjustment[N_SQUARES];
-int8_t black_bishop_position_adjustment[N_SQUARES];
-int8_t black_queen_position_adjustment[N_SQUARES];
-int8_t black_king_position_adjustment[N_SQUARES];
-
-void initializePositionTables(void) {
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+#include <immintrin.h>
+#endif
+
+// Pawn structure.
+const int16_t DOUBLED_PAWN_PENALTY = 10;
+const int16_t ISOLATED_PAWN_PENALTY = 10;
+const int16_t passed_pawn_bonus[8] = {0, 5, 10, 20, 35, 60, 100, 0};
+
+// Bonus per safe square attacked, indexed by piece type.
+const int16_t mobility_bonus[N_PIECE_TYPES] = {0, 4, 4, 2, 1, 0};
+
+// Weight of the enemy attacks on the king zone, indexed by piece type.
+const int16_t king_attack_weight[N_PIECE_TYPES] = {0, 2, 2, 3, 5, 0};
+const int16_t MAX_KING_ATTACK_PENALTY = 100;
+const int16_t PAWN_SHIELD_BONUS = 10;
+
+// Upper bounds of the pawn structure and attack based terms. The terms are
+// clamped to these, so a lazy evaluation can safely exit early when the score
+// is this far outside the alpha/beta window.
+const int16_t PAWN_STRUCTURE_MARGIN = 200;
+const int16_t ATTACKS_MARGIN = 150;
+
+const uint64_t file_masks[8] = {file_a, file_b, file_c, file_d,
+                                file_e, file_f, file_g, file_h};
+
+thread_local EvaluationStats evaluation_stats;
+
+/** Mirrors a white positional table to get the respective black positional
+ *  table.
+ *
+ * @param white_position_adjustment: White positional table.
+ * @return Black positional table.
+ */
+constexpr std::array<int8_t, N_SQUARES>
+mirrorPositionTable(const int8_t (&white_position_adjustment)[N_SQUARES]) {
+  std::array<int8_t, N_SQUARES> black_position_adjustment{};
   for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
-    black_pawn_position_adjustment[bit] =
-        white_pawn_position_adjustment[63 - bit];
-    black_knight_position_adjustment[bit] =
-        white_knight_position_adjustment[63 - bit];
-    black_bishop_position_adjustment[bit] =
-        white_bishop_position_adjustment[63 - bit];
-    black_rook_position_adjustment[bit] =
-        white_rook_position_adjustment[63 - bit];
-    black_queen_position_adjustment[bit] =
-        white_queen_position_adjustment[63 - bit];
-    black_king_position_adjustment[bit] =
-        white_king_position_adjustment[63 - bit];
+    black_position_adjustment[bit] = white_position_adjustment[63 - bit];
   }
+  return black_position_adjustment;
 }
 
+constexpr std::array<int8_t, N_SQUARES> black_pawn_position_adjustment =
+    mirrorPositionTable(white_pawn_position_adjustment);
+constexpr std::array<int8_t, N_SQUARES> black_knight_position_adjustment =
+    mirrorPositionTable(white_knight_position_adjustment);
+constexpr std::array<int8_t, N_SQUARES> black_rook_position_adjustment =
+    mirrorPositionTable(white_rook_position_adjustment);
+constexpr std::array<int8_t, N_SQUARES> black_bishop_position_adjustment =
+    mirrorPositionTable(white_bishop_position_adjustment);
+constexpr std::array<int8_t, N_SQUARES> black_queen_position_adjustment =
+    mirrorPositionTable(white_queen_position_adjustment);
+constexpr std::array<int8_t, N_SQUARES> black_king_position_adjustment =
+    mirrorPositionTable(white_king_position_adjustment);
+
+constexpr int16_t material_values[N_PIECE_TYPES] = {
+    PAWN_VALUE, KNIGHT_VALUE, BISHOP_VALUE, ROOK_VALUE, QUEEN_VALUE, 0};
+
+constexpr const int8_t *position_adjustments[N_COLORS][N_PIECE_TYPES] = {
+    {white_pawn_position_adjustment, white_knight_position_adjustment,
+     white_bishop_position_adjustment, white_rook_position_adjustment,
+     white_queen_position_adjustment, white_king_position_adjustment},
+    {black_pawn_position_adjustment.data(),
+     black_knight_position_adjustment.data(),
+     black_bishop_position_adjustment.data(),
+     black_rook_position_adjustment.data(),
+     black_queen_position_adjustment.data(),
+     black_king_position_adjustment.data()}};
+
 /** Returns a score value of the respective material and the position on the
  *  board.
  *
@@ -125,38 +103,357 @@ int16_t getIndividualBitboardScoreMaterialAndPosition(
  * @param game_state: Game state.
  * @return Score value.
  */
-int16_t getScoreMaterialAndPosition(GameState game_state) {
-  int16_t w_counter = 0;
-  w_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.white.pawn, white_pawn_position_adjustment, PAWN_VALUE);
-  w_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.white.knight, white_knight_position_adjustment, KNIGHT_VALUE);
-  w_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.white.bishop, white_bishop_position_adjustment, BISHOP_VALUE);
-  w_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.white.rook, white_rook_position_adjustment, ROOK_VALUE);
-  w_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.white.queen, white_queen_position_adjustment, QUEEN_VALUE);
-  w_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.white.king, white_king_position_adjustment, 0);
-
-  int16_t b_counter = 0;
-  b_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.black.pawn, black_pawn_position_adjustment, PAWN_VALUE);
-  b_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.black.knight, black_knight_position_adjustment, KNIGHT_VALUE);
-  b_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.black.bishop, black_bishop_position_adjustment, BISHOP_VALUE);
-  b_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.black.rook, black_rook_position_adjustment, ROOK_VALUE);
-  b_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.black.queen, black_queen_position_adjustment, QUEEN_VALUE);
-  b_counter += getIndividualBitboardScoreMaterialAndPosition(
-      game_state.black.king, black_king_position_adjustment, 0);
-
-  return w_counter - b_counter;
-}
-
-int16_t evaluatePosition(const GameState game_state) {
-  return getScoreMaterialAndPosition(game_state);
-}
\ No newline at end of file
+int16_t getScoreMaterialAndPosition(const GameState &game_state) {
+  int16_t counters[N_COLORS] = {0, 0};
+  for (uint8_t color = WHITE; color < N_COLORS; color++) {
+    for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+      counters[color] += getIndividualBitboardScoreMaterialAndPosition(
+          game_state.pieces[color][piece_type],
+          position_adjustments[color][piece_type],
+          material_values[piece_type]);
+    }
+  }
+  return counters[WHITE] - counters[BLACK];
+}
+
+/** Generates the masks of the squares that must be free of enemy pawns for a
+ *  pawn to be passed. The file of the pawn and the adjacent files, on the ranks
+ *  ahead of the pawn.
+ *
+ * @return Passed pawn masks, indexed by color and square.
+ */
+constexpr std::array<std::array<uint64_t, N_SQUARES>, N_COLORS>
+generatePassedPawnMasks(void) {
+  std::array<std::array<uint64_t, N_SQUARES>, N_COLORS> masks{};
+  for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
+    uint8_t file = bit % 8;
+    uint8_t rank = bit / 8;
+    uint64_t files = file_masks[file];
+    files |= file > 0 ? file_masks[file - 1] : 0;
+    files |= file < 7 ? file_masks[file + 1] : 0;
+    masks[WHITE][bit] = rank == 7 ? 0 : files & (FILLED << ((rank + 1) * 8));
+    masks[BLACK][bit] = files & ((1ULL << (rank * 8)) - 1);
+  }
+  return masks;
+}
+
+constexpr std::array<std::array<uint64_t, N_SQUARES>, N_COLORS>
+    passed_pawn_masks = generatePassedPawnMasks();
+
+/** Returns the pawn structure score of a player. Penalizes doubled and
+ *  isolated pawns, and rewards passed pawns.
+ *
+ * @param color: Color of the player.
+ * @param P: Bitboard of the player's pawns.
+ * @param EP: Bitboard of the enemy player's pawns.
+ * @return Score value.
+ */
+int16_t getPawnStructureScore(Color color, uint64_t P, uint64_t EP) {
+  int16_t score = 0;
+  for (uint8_t file = 0; file < 8; file++) {
+    uint8_t n_pawns = countSetBits(P & file_masks[file]);
+    if (!n_pawns) {
+      continue;
+    }
+    score -= DOUBLED_PAWN_PENALTY * (n_pawns - 1);
+    uint64_t adjacent_files = (file > 0 ? file_masks[file - 1] : 0) |
+                              (file < 7 ? file_masks[file + 1] : 0);
+    if (!(P & adjacent_files)) {
+      score -= ISOLATED_PAWN_PENALTY * n_pawns;
+    }
+  }
+
+  while (P) {
+    uint8_t bit = getSetBit(getLowestSetBitValue(P));
+    if (!(passed_pawn_masks[color][bit] & EP)) {
+      score += passed_pawn_bonus[color == WHITE ? bit / 8 : 7 - bit / 8];
+    }
+    clearLowestSetBit(P);
+  }
+  return score;
+}
+
+/** Returns the mobility score of a player. Rewards every square attacked by
+ *  the minor/major pieces that is not occupied by the player's own pieces and
+ *  not attacked by enemy pawns.
+ *
+ * @param color: Color of the player.
+ * @param attack_info: Attack information of the game state.
+ * @param PIECES: Bitboard of the player's pieces.
+ * @return Score value.
+ */
+int16_t getMobilityScore(Color color, const AttackInfo &attack_info,
+                         uint64_t PIECES) {
+  uint64_t safe_squares =
+      ~PIECES & ~attack_info.attacks[color == WHITE ? BLACK : WHITE][PAWN];
+  int16_t score = 0;
+  for (uint8_t piece_type = KNIGHT; piece_type <= QUEEN; piece_type++) {
+    uint64_t attacks = attack_info.attacks[color][piece_type];
+    score += mobility_bonus[piece_type] * countSetBits(attacks & safe_squares);
+  }
+  return score;
+}
+
+/** Returns the king safety score of a player. Penalizes enemy attacks on the
+ *  squares around the king, and rewards pawns sheltering the king.
+ *
+ * @param color: Color of the player.
+ * @param attack_info: Attack information of the game state.
+ * @param K: Bitboard of the player's king.
+ * @param P: Bitboard of the player's pawns.
+ * @return Score value.
+ */
+int16_t getKingSafetyScore(Color color, const AttackInfo &attack_info,
+                           uint64_t K, uint64_t P) {
+  Color enemy_color = color == WHITE ? BLACK : WHITE;
+  uint64_t king_zone = K | king_moves[getSetBit(K)];
+  int16_t attack_units = 0;
+  for (uint8_t piece_type = KNIGHT; piece_type <= QUEEN; piece_type++) {
+    attack_units +=
+        king_attack_weight[piece_type] *
+        countSetBits(attack_info.attacks[enemy_color][piece_type] & king_zone);
+  }
+  int16_t score = -std::min<int16_t>(attack_units * attack_units / 2,
+                                     MAX_KING_ATTACK_PENALTY);
+
+  // Pawn shield, only while the king is still on its first two ranks.
+  if (K & (color == WHITE ? rank_1 | rank_2 : rank_7 | rank_8)) {
+    uint64_t shield = color == WHITE ? (K << 8) | ((K << 7) & ~file_h) |
+                                           ((K << 9) & ~file_a)
+                                     : (K >> 8) | ((K >> 9) & ~file_h) |
+                                           ((K >> 7) & ~file_a);
+    score += PAWN_SHIELD_BONUS * countSetBits(P & shield);
+  }
+  return score;
+}
+
+/** Returns the pawn structure term of the evaluation, bounded by its margin.
+ *
+ * @param game_state: Game state.
+ * @return Score value, from white's perspective.
+ */
+int16_t getPawnStructureTerm(const GameState &game_state) {
+  return std::clamp<int16_t>(
+      getPawnStructureScore(WHITE, game_state.pieces[WHITE][PAWN],
+                            game_state.pieces[BLACK][PAWN]) -
+          getPawnStructureScore(BLACK, game_state.pieces[BLACK][PAWN],
+                                game_state.pieces[WHITE][PAWN]),
+      -PAWN_STRUCTURE_MARGIN, PAWN_STRUCTURE_MARGIN);
+}
+
+/** Returns the mobility and king safety term of the evaluation, bounded by its
+ *  margin.
+ *
+ * @param game_state: Game state.
+ * @return Score value, from white's perspective.
+ */
+int16_t getAttacksTerm(const GameState &game_state) {
+  AttackInfo attack_info;
+  computeAttackInfo(game_state, attack_info);
+  return std::clamp<int16_t>(
+      getMobilityScore(WHITE, attack_info, game_state.occupancy[WHITE]) -
+          getMobilityScore(BLACK, attack_info, game_state.occupancy[BLACK]) +
+          getKingSafetyScore(WHITE, attack_info, game_state.pieces[WHITE][KING],
+                             game_state.pieces[WHITE][PAWN]) -
+          getKingSafetyScore(BLACK, attack_info, game_state.pieces[BLACK][KING],
+                             game_state.pieces[BLACK][PAWN]),
+      -ATTACKS_MARGIN, ATTACKS_MARGIN);
+}
+
+/** Returns true if the score is far enough outside the window, that a term
+ *  bounded by the margin cannot bring it back inside.
+ *
+ * @param score: Score value.
+ * @param alpha: Lower bound of the window.
+ * @param beta: Upper bound of the window.
+ * @param margin: Upper bound of the remaining terms.
+ * @return True if the evaluation can exit early.
+ */
+bool canExitLazily(int16_t score, int16_t alpha, int16_t beta,
+                   int16_t margin) {
+  return score + margin <= alpha || score - margin >= beta;
+}
+
+int16_t evaluatePosition(const GameState &game_state, int16_t alpha,
+                         int16_t beta) {
+  evaluation_stats.n_evaluations++;
+
+  // Stage 1: material and position.
+  int16_t score = getScoreMaterialAndPosition(game_state);
+  if (canExitLazily(score, alpha, beta,
+                    PAWN_STRUCTURE_MARGIN + ATTACKS_MARGIN)) {
+    evaluation_stats.n_lazy_exits++;
+    return score;
+  }
+
+  // Stage 2: pawn structure.
+  score += getPawnStructureTerm(game_state);
+  if (canExitLazily(score, alpha, beta, ATTACKS_MARGIN)) {
+    evaluation_stats.n_lazy_exits++;
+    return score;
+  }
+
+  // Stage 3: mobility and king safety, from the shared attack information.
+  score += getAttacksTerm(game_state);
+  return score;
+}
+
+int16_t evaluatePosition(const GameState &game_state) {
+  return evaluatePosition(game_state, -INT16_MAX, INT16_MAX);
+}
+
+void PositionBatch::addPosition(const GameState &game_state) {
+  for (uint8_t color = WHITE; color < N_COLORS; color++) {
+    for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+      pieces[color][piece_type].push_back(game_state.pieces[color][piece_type]);
+    }
+  }
+  castling_rights.push_back(game_state.castling_rights);
+  whites_turn.push_back(game_state.side_to_move == WHITE);
+  en_passant.push_back(game_state.en_passant);
+}
+
+GameState PositionBatch::getPosition(uint32_t index) const {
+  GameState game_state;
+  for (uint8_t color = WHITE; color < N_COLORS; color++) {
+    for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+      game_state.pieces[color][piece_type] = pieces[color][piece_type][index];
+    }
+  }
+  game_state.castling_rights = castling_rights[index];
+  game_state.side_to_move = whites_turn[index] ? WHITE : BLACK;
+  game_state.en_passant = en_passant[index];
+  populateBoard(game_state);
+  updateCheckState(game_state);
+  return game_state;
+}
+
+/** Splits the positional table of a piece type into bit planes. Plane k holds
+ *  the squares whose (offset by 128, so unsigned) positional value has bit k
+ *  set. The material and positional score of a bitboard is then a weighted sum
+ *  of popcounts, which vectorizes across positions:
+ *  (value - 128) * popcount(bitboard) + sum(popcount(bitboard & plane_k) << k).
+ *
+ * @param position_adjustment: Positional table, from white's perspective.
+ * @param color: Color of the pieces.
+ * @return Bit planes.
+ */
+constexpr std::array<uint64_t, 8>
+generatePositionPlanes(const int8_t (&position_adjustment)[N_SQUARES],
+                       Color color) {
+  std::array<uint64_t, 8> planes{};
+  for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
+    uint8_t value =
+        position_adjustment[color == WHITE ? bit : 63 - bit] - INT8_MIN;
+    for (uint8_t k = 0; k < 8; k++) {
+      planes[k] |= (uint64_t)((value >> k) & 1) << bit;
+    }
+  }
+  return planes;
+}
+
+constexpr std::array<uint64_t, 8> position_planes[N_COLORS][N_PIECE_TYPES] = {
+    {generatePositionPlanes(white_pawn_position_adjustment, WHITE),
+     generatePositionPlanes(white_knight_position_adjustment, WHITE),
+     generatePositionPlanes(white_bishop_position_adjustment, WHITE),
+     generatePositionPlanes(white_rook_position_adjustment, WHITE),
+     generatePositionPlanes(white_queen_position_adjustment, WHITE),
+     generatePositionPlanes(white_king_position_adjustment, WHITE)},
+    {generatePositionPlanes(white_pawn_position_adjustment, BLACK),
+     generatePositionPlanes(white_knight_position_adjustment, BLACK),
+     generatePositionPlanes(white_bishop_position_adjustment, BLACK),
+     generatePositionPlanes(white_rook_position_adjustment, BLACK),
+     generatePositionPlanes(white_queen_position_adjustment, BLACK),
+     generatePositionPlanes(white_king_position_adjustment, BLACK)}};
+
+/** Computes the material and positional scores of a range of positions, one
+ *  position at a time, looping over the set bits.
+ *
+ * @param batch: Positions.
+ * @param scores: Score values, one per position.
+ * @param begin: First position.
+ * @param end: Last position (exclusive).
+ */
+void evaluateMaterialAndPositionsScalar(const PositionBatch &batch,
+                                        int16_t *scores, uint32_t begin,
+                                        uint32_t end) {
+  for (uint32_t i = begin; i < end; i++) {
+    int16_t score = 0;
+    for (uint8_t color = WHITE; color < N_COLORS; color++) {
+      for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES;
+           piece_type++) {
+        int16_t piece_score = getIndividualBitboardScoreMaterialAndPosition(
+            batch.pieces[color][piece_type][i],
+            position_adjustments[color][piece_type],
+            material_values[piece_type]);
+        score += color == WHITE ? piece_score : -piece_score;
+      }
+    }
+    scores[i] = score;
+  }
+}
+
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+/** Computes the material and positional scores of a range of positions, 8
+ *  positions at a time, with the bit plane popcounts. Requires AVX-512
+ *  VPOPCNTDQ.
+ *
+ * @param batch: Positions.
+ * @param scores: Score values, one per position.
+ * @param begin: First position.
+ * @param end: Last position (exclusive).
+ * @return First position that was not evaluated (less than 8 left).
+ */
+__attribute__((target("avx512f,avx512vpopcntdq"))) uint32_t
+evaluateMaterialAndPositionsAvx512(const PositionBatch &batch, int16_t *scores,
+                                   uint32_t begin, uint32_t end) {
+  uint32_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    __m512i total = _mm512_setzero_si512();
+    for (uint8_t color = WHITE; color < N_COLORS; color++) {
+      for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES;
+           piece_type++) {
+        const std::array<uint64_t, 8> &planes =
+            position_planes[color][piece_type];
+        __m512i bitboards =
+            _mm512_loadu_si512(&batch.pieces[color][piece_type][i]);
+        // Only the lower 32 bits of each lane are used. Scores are truncated
+        // to 16 bits at the end.
+        __m512i score = _mm512_mullo_epi32(
+            _mm512_popcnt_epi64(bitboards),
+            _mm512_set1_epi64(material_values[piece_type] + INT8_MIN));
+        for (uint8_t k = 0; k < 8; k++) {
+          __m512i count = _mm512_popcnt_epi64(
+              _mm512_and_si512(bitboards, _mm512_set1_epi64(planes[k])));
+          score = _mm512_add_epi64(score, _mm512_slli_epi64(count, k));
+        }
+        total = color == WHITE ? _mm512_add_epi64(total, score)
+                               : _mm512_sub_epi64(total, score);
+      }
+    }
+    _mm_storeu_si128((__m128i *)&scores[i], _mm512_cvtepi64_epi16(total));
+  }
+  return i;
+}
+#endif
+
+void evaluateMaterialAndPositions(const PositionBatch &batch, int16_t *scores) {
+  uint32_t begin = 0;
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+  if (cpuSupportsAvx512Popcount()) {
+    begin = evaluateMaterialAndPositionsAvx512(batch, scores, 0, batch.size());
+  }
+#endif
+  evaluateMaterialAndPositionsScalar(batch, scores, begin, batch.size());
+}
+
+void evaluatePositions(const PositionBatch &batch, int16_t *scores) {
+  evaluateMaterialAndPositions(batch, scores);
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    GameState game_state = batch.getPosition(i);
+    scores[i] += getPawnStructureTerm(game_state);
+    scores[i] += getAttacksTerm(game_state);
+  }
+}
+
+EvaluationStats &getEvaluationStats(void) { return evaluation_stats; }
\ No newline at end of file
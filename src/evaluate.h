@@ -1,6 +1,45 @@
 #pragma once
 
 #include "board.h"
+#include "constants.h"
+#include <vector>
+
+// Counters of the evaluations done by the current thread. Used for
+// benchmarking.
+struct EvaluationStats {
+  uint64_t n_evaluations = 0;
+  uint64_t n_lazy_exits = 0;
+};
+
+/** Positions stored in a structure-of-arrays layout, one array per field, for
+ *  evaluating many unrelated positions at once.
+ */
+struct PositionBatch {
+  // Piece bitboards, indexed by color and piece type.
+  std::vector<uint64_t> pieces[N_COLORS][N_PIECE_TYPES];
+
+  // Castling rights. Bits: 0: white king side, 1: white queen side, 2: black
+  // king side, 3: black queen side.
+  std::vector<uint8_t> castling_rights;
+
+  std::vector<bool> whites_turn;
+  std::vector<int8_t> en_passant;
+
+  /** Appends a position to the batch.
+   *
+   * @param game_state: Game state.
+   */
+  void addPosition(const GameState &game_state);
+
+  /** Returns a position of the batch.
+   *
+   * @param index: Index of the position.
+   * @return Game state.
+   */
+  GameState getPosition(uint32_t index) const;
+
+  uint32_t size(void) const { return en_passant.size(); }
+};
 
 /** Returns a score value of the board position. Always evaluated from white's
  *  perspective. White score = -Black score.
@@ -8,9 +47,40 @@
  * @param game_state: Game state.
  * @return Score value.
  */
-int16_t evaluatePosition(const GameState game_state);
+int16_t evaluatePosition(const GameState &game_state);
 
-/** Initializes the values of the black positional tables. Just a mirror of
- *  the white positional tables.
+/** Returns a score value of the board position, evaluated lazily. The cheap
+ *  material/positional score is computed first, and the expensive terms are
+ *  only computed if they could bring the score back inside the alpha/beta
+ *  window. Always evaluated from white's perspective.
+ *
+ * @param game_state: Game state.
+ * @param alpha: Lower bound of the window, from white's perspective.
+ * @param beta: Upper bound of the window, from white's perspective.
+ * @return Exact score if it is inside the window, else a score on the same
+ * side of the window as the exact score.
+ */
+int16_t evaluatePosition(const GameState &game_state, int16_t alpha,
+                         int16_t beta);
+
+/** Evaluates all the positions of a batch. The material and positional score
+ *  is accumulated across the positions in blocks, the remaining terms per
+ *  position. Always evaluated from white's perspective.
+ *
+ * @param batch: Positions.
+ * @param scores: Score values, one per position. Same as evaluatePosition().
+ */
+void evaluatePositions(const PositionBatch &batch, int16_t *scores);
+
+/** Computes only the material and positional scores of a batch.
+ *
+ * @param batch: Positions.
+ * @param scores: Score values, one per position.
+ */
+void evaluateMaterialAndPositions(const PositionBatch &batch, int16_t *scores);
+
+/** Returns the evaluation counters of the current thread.
+ *
+ * @return Evaluation counters.
  */
-void initializePositionTables(void);
+EvaluationStats &getEvaluationStats(void);
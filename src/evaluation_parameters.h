@@ -0,0 +1,90 @@
+#pragma once
+
+// Material values and positional tables used by the evaluation. Can be
+// regenerated by the tuner ("venus_chess tune ...").
+
+#include "constants.h"
+#include <iterator>
+#include <stdint.h>
+
+const int16_t PAWN_VALUE = 100;
+const int16_t KNIGHT_VALUE = 300;
+const int16_t BISHOP_VALUE = 300;
+const int16_t ROOK_VALUE = 500;
+const int16_t QUEEN_VALUE = 900;
+
+// clang-format off
+constexpr int8_t white_pawn_position_adjustment[] = {
+   0,   0,   0,   0,    0,    0,   0,   0,
+   5,   10,  10, -20,  -20,   10,  10,  5,
+   5,  -5,  -10,  0,    0,   -10, -5,   5,
+   0,   0,   0,   20,   20,   0,   0,   0,
+   5,   5,   10,  25,   25,   10,  5,   5,
+   10,  10,  20,  30,   30,   20,  10,  10,
+   50,  50,  50,  50,   50,   50,  50,  50,
+   0,   0,   0,   0,    0,    0,   0,   0,
+};
+
+constexpr int8_t white_knight_position_adjustment[] = {
+  -50, -40, -30, -30, -30, -30, -40, -50,
+  -40, -20,  0,   5,   5,   0,  -20, -40,
+  -30,  5,   10,  15,  15,  10,  5,  -30,
+  -30,  0,   15,  20,  20,  15,  0,  -30, 
+  -30,  5,   15,  20,  20,  15,  5,  -30, 
+  -30,  0,   10,  15,  15,  10,  0,  -30,
+  -40, -20,  0,   0,   0,   0,  -20, -40,
+  -50, -40, -30, -30, -30, -30, -40, -50,
+};
+
+constexpr int8_t white_rook_position_adjustment[] = {
+   0,   0,   5,   10,  10,  5,   0,   0,
+  -5,   0,   0,   0,   0,   0,   0,  -5,
+  -5,   0,   0,   0,   0,   0,   0,  -5,
+  -5,   0,   0,   0,   0,   0,   0,  -5,
+  -5,   0,   0,   0,   0,   0,   0,  -5,
+  -5,   0,   0,   0,   0,   0,   0,  -5,
+   5,   10,  10,  10,  10,  10,  10,  5,
+   0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+constexpr int8_t white_bishop_position_adjustment[] = {
+  -20, -10, -10, -10, -10, -10, -10, -20,
+  -10,  5,   0,   0,   0,   0,   5,  -10,
+  -10,  10,  10,  10,  10,  10,  10, -10,
+  -10,  0,   10,  10,  10,  10,  0,  -10,
+  -10,  5,   5,   10,  10,  5,   5,  -10, 
+  -10,  0,   5,   10,  10,  5,   0,  -10,
+  -10,  0,   0,   0,   0,   0,   0,  -10,
+  -20, -10, -10, -10, -10, -10, -10, -20,
+};
+
+constexpr int8_t white_queen_position_adjustment[] = {
+  -20, -10, -10, -5,  -5,  -10, -10, -20,
+  -10,  0,   5,   0,   0,   0,   0,  -10, 
+  -10,  5,   5,   5,   5,   5,   0,  -10, 
+   0,   0,   5,   5,   5,   5,   0,  -5,  
+  -5,   0,   5,   5,   5,   5,   0,  -5,
+  -10,  0,   5,   5,   5,   5,   0,  -10,
+  -10,  0,   0,   0,   0,   0,   0,  -10, 
+  -20, -10, -10, -5,  -5,  -10, -10, -20,
+};
+
+constexpr int8_t white_king_position_adjustment[] = {
+   20,  30,  10,  0,   0,   10,  30,  20,
+   20,  20,  0,   0,   0,   0,   20,  20, 
+  -10, -20, -20, -20, -20, -20, -20, -10, 
+  -20, -30, -30, -40, -40, -30, -30, -20,
+  -30, -40, -40, -50, -50, -40, -40, -30, 
+  -30, -40, -40, -50, -50, -40, -40, -30, 
+  -30, -40, -40, -50, -50, -40, -40, -30, 
+  -30, -40, -40, -50, -50, -40, -40, -30,
+};
+// clang-format on
+
+// A missing comma silently merges two entries, so check the table sizes.
+static_assert(std::size(white_pawn_position_adjustment) == N_SQUARES);
+static_assert(std::size(white_knight_position_adjustment) == N_SQUARES);
+static_assert(std::size(white_rook_position_adjustment) == N_SQUARES);
+static_assert(std::size(white_bishop_position_adjustment) == N_SQUARES);
+static_assert(std::size(white_queen_position_adjustment) == N_SQUARES);
+static_assert(std::size(white_king_position_adjustment) == N_SQUARES);
@@ -1,47 +1,54 @@
 #include "helper_functions.h"
 #include <bitset>
 #include <iostream>
-#include <random>
 #include <stdint.h>
 #include <string>
 #include <fstream>
 
-uint64_t reverse(uint64_t x) {
-  x = (x >> 32) | (x << 32);
-  x = ((x & 0xFFFF0000FFFF0000) >> 16) | ((x & 0x0000FFFF0000FFFF) << 16);
-  x = ((x & 0xFF00FF00FF00FF00) >> 8) | ((x & 0x00FF00FF00FF00FF) << 8);
-  x = ((x & 0xF0F0F0F0F0F0F0F0) >> 4) | ((x & 0x0F0F0F0F0F0F0F0F) << 4);
-  x = ((x & 0xCCCCCCCCCCCCCCCC) >> 2) | ((x & 0x3333333333333333) << 2);
-  x = ((x & 0xAAAAAAAAAAAAAAAA) >> 1) | ((x & 0x5555555555555555) << 1);
-  return x;
-}
-
-uint8_t getSetBit(uint64_t x) { return 63 - __builtin_clzll(x); }
-
 void logErrorAndExit(std::string error_message) {
   std::cout << error_message << std::endl;
   exit(1);
 }
 
+std::string_view getNextToken(std::string_view text, size_t &pos) {
+  auto isSeparator = [](char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  };
+  while (pos < text.size() && isSeparator(text[pos])) {
+    pos++;
+  }
+  size_t begin = pos;
+  while (pos < text.size() && !isSeparator(text[pos])) {
+    pos++;
+  }
+  return text.substr(begin, pos - begin);
+}
+
 uint64_t getLowestSetBitValue(uint64_t x) { return x & ~(x - 1); }
 
 void clearLowestSetBit(uint64_t &x) { x &= (x - 1); }
 
-uint8_t countSetBits(uint64_t x) {
-  uint8_t count = 0;
-  while (x) {
-    clearLowestSetBit(x);
-    count++;
-  }
-  return count;
+bool cpuSupportsAvx512Popcount(void) {
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+  __builtin_cpu_init();
+  static const bool supported = __builtin_cpu_supports("avx512f") &&
+                                __builtin_cpu_supports("avx512vpopcntdq");
+  return supported;
+#else
+  return false;
+#endif
 }
 
-uint64_t generateRandom64(void) {
-  std::random_device rd;
-  std::mt19937_64 gen(rd());
-  std::uniform_int_distribution<> distrib(0U, UINT32_MAX);
-  return (distrib(gen) & 0xFFFFFFFF) |
-         (((uint64_t)distrib(gen) & 0xFFFFFFFF) << 32);
+bool cpuSupportsFastPext(void) {
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+  __builtin_cpu_init();
+  static const bool supported = __builtin_cpu_supports("bmi2") &&
+                                !__builtin_cpu_is("amdfam15h") &&
+                                !__builtin_cpu_is("amdfam17h");
+  return supported;
+#else
+  return false;
+#endif
 }
 
 void printBitboard(uint64_t bitboard) {
@@ -1,15 +1,33 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <stdint.h>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// x86-64 GCC/Clang, which support per-function target attributes and inline
+// assembly. Used for the instruction set extensions detected at runtime.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HAS_X86_TARGET_ATTRIBUTES 1
+#endif
 
 /** Reverses the bits of a 64 bit integer.
  *
  * @param x: 64 bit integer.
  * @return Integer with reversed bits.
  */
-uint64_t reverse(uint64_t x);
+constexpr inline uint64_t reverse(uint64_t x) {
+  x = (x >> 32) | (x << 32);
+  x = ((x & 0xFFFF0000FFFF0000) >> 16) | ((x & 0x0000FFFF0000FFFF) << 16);
+  x = ((x & 0xFF00FF00FF00FF00) >> 8) | ((x & 0x00FF00FF00FF00FF) << 8);
+  x = ((x & 0xF0F0F0F0F0F0F0F0) >> 4) | ((x & 0x0F0F0F0F0F0F0F0F) << 4);
+  x = ((x & 0xCCCCCCCCCCCCCCCC) >> 2) | ((x & 0x3333333333333333) << 2);
+  x = ((x & 0xAAAAAAAAAAAAAAAA) >> 1) | ((x & 0x5555555555555555) << 1);
+  return x;
+}
 
 /** Returns the position of the set bit. Behavior is defined for numbers that
  * have exactly 1 bit set.
@@ -17,7 +35,56 @@ uint64_t reverse(uint64_t x);
  * @param x: Number.
  * @return The position of the set bit.
  */
-uint8_t getSetBit(uint64_t x);
+constexpr inline uint8_t getSetBit(uint64_t x) {
+  return 63 - __builtin_clzll(x);
+}
+
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+/** Gathers the bits of x selected by the mask into the low bits (BMI2 PEXT).
+ * Emitted as inline assembly, so it inlines into code that is not compiled for
+ * BMI2. Only call it if cpuSupportsFastPext() is true.
+ *
+ * @param x: Number.
+ * @param mask: Bits to extract.
+ * @return Extracted bits.
+ */
+inline uint64_t extractBits(uint64_t x, uint64_t mask) {
+  uint64_t result;
+  asm("pextq %2, %1, %0" : "=r"(result) : "r"(x), "r"(mask));
+  return result;
+}
+#endif
+
+/** Returns the next whitespace separated token of the text, and advances past
+ * it.
+ *
+ * @param text: Text.
+ * @param pos: Position in the text.
+ * @return Token, empty if there are no more tokens.
+ */
+std::string_view getNextToken(std::string_view text, size_t &pos);
+
+/** Splits the items into contiguous ranges and processes them on all cores.
+ *
+ * @param n_items: Number of items.
+ * @param function: Called as function(thread_index, begin, end).
+ * @return Number of threads used.
+ */
+template <typename Function>
+uint32_t runInParallel(uint32_t n_items, Function function) {
+  uint32_t n_threads =
+      std::max(1u, std::min(std::thread::hardware_concurrency(), n_items));
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < n_threads; i++) {
+    uint32_t begin = (uint64_t)n_items * i / n_threads;
+    uint32_t end = (uint64_t)n_items * (i + 1) / n_threads;
+    threads.emplace_back(function, i, begin, end);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  return n_threads;
+}
 
 /** Prints an error message and exits the program.
  *
@@ -43,13 +110,24 @@ void clearLowestSetBit(uint64_t &x);
  * @param x: Number.
  * @return The count of set bits.
  */
-uint8_t countSetBits(uint64_t x);
+constexpr inline uint8_t countSetBits(uint64_t x) {
+  return __builtin_popcountll(x);
+}
+
+/** Returns true if the CPU supports the AVX-512 vector popcount instructions.
+ *  Checked once, at runtime.
+ *
+ * @return True if AVX-512 VPOPCNTDQ is available.
+ */
+bool cpuSupportsAvx512Popcount(void);
 
-/** Generates a random 64 bit integer..
+/** Returns true if the CPU has fast BMI2 instructions (PEXT). AMD CPUs before
+ *  Zen 3 support PEXT, but microcode it and are slower than a multiply.
+ *  Checked once, at runtime.
  *
- * @return Random 64 bit integer.
+ * @return True if PEXT is available and fast.
  */
-uint64_t generateRandom64(void);
+bool cpuSupportsFastPext(void);
 
 /** Prints a bitboard as a 8x8 grid.
  *
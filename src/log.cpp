@@ -0,0 +1,203 @@
+#include "log.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Number of lines the ring buffer holds, and the maximum length of a line.
+const uint32_t LOG_CAPACITY = 1024;
+const uint16_t LOG_LINE_SIZE = 500;
+
+// Slot of the ring buffer. Its sequence number tells whose turn it is: the slot
+// for position pos is free to write when its sequence is pos, and ready to
+// read when it is pos + 1.
+struct LogSlot {
+  std::atomic<uint64_t> sequence;
+  uint16_t length;
+  char text[LOG_LINE_SIZE];
+};
+
+/** Lock-free ring buffer of log lines, with many producers and one consumer:
+ * a background thread that writes the lines to the log file.
+ */
+class AsyncLogger {
+public:
+  AsyncLogger() : slots(new LogSlot[LOG_CAPACITY]) {
+    for (uint32_t i = 0; i < LOG_CAPACITY; i++) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~AsyncLogger() { stop(); }
+
+  LogLevel getLevel(void) const {
+    return level.load(std::memory_order_relaxed);
+  }
+
+  void setLevel(LogLevel new_level) {
+    level.store(new_level, std::memory_order_relaxed);
+    if (new_level != LOG_OFF) {
+      start();
+    }
+  }
+
+  void setPath(const std::string &new_path) {
+    std::lock_guard<std::mutex> lock(path_mutex);
+    path = new_path;
+    reopen = true;
+  }
+
+  /** Queues a line, made of a prefix and the text.
+   *
+   * @param prefix: Prefix of the line.
+   * @param text: Text of the line.
+   */
+  void push(std::string_view prefix, std::string_view text) {
+    uint64_t pos = tail.load(std::memory_order_relaxed);
+    LogSlot *slot;
+    while (true) {
+      slot = &slots[pos % LOG_CAPACITY];
+      int64_t lag = slot->sequence.load(std::memory_order_acquire) - pos;
+      if (lag == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lag < 0) {
+        // The consumer hasn't read this slot yet: the ring buffer is full.
+        n_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    uint16_t prefix_length = std::min<size_t>(prefix.size(), LOG_LINE_SIZE);
+    uint16_t text_length =
+        std::min<size_t>(text.size(), LOG_LINE_SIZE - prefix_length);
+    memcpy(slot->text, prefix.data(), prefix_length);
+    memcpy(slot->text + prefix_length, text.data(), text_length);
+    slot->length = prefix_length + text_length;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    n_published.fetch_add(1, std::memory_order_release);
+    n_published.notify_one();
+  }
+
+  void start(void) {
+    std::lock_guard<std::mutex> lock(thread_mutex);
+    if (!thread.joinable()) {
+      stopping.store(false);
+      thread = std::thread(&AsyncLogger::run, this);
+    }
+  }
+
+  void stop(void) {
+    std::lock_guard<std::mutex> lock(thread_mutex);
+    if (thread.joinable()) {
+      stopping.store(true);
+      n_published.fetch_add(1, std::memory_order_release);
+      n_published.notify_one();
+      thread.join();
+    }
+  }
+
+private:
+  /** Writes the queued lines to the log file, flushing it after each batch, and
+   * sleeps until more lines are queued.
+   */
+  void run(void) {
+    std::ofstream file;
+    uint64_t head = 0;
+    uint64_t n_reported_dropped = 0;
+    while (true) {
+      uint64_t published = n_published.load(std::memory_order_acquire);
+      bool stop_after_batch = stopping.load();
+      {
+        std::lock_guard<std::mutex> lock(path_mutex);
+        if (reopen) {
+          file.close();
+          file.open(path, std::ios_base::app);
+          reopen = false;
+        }
+      }
+
+      bool wrote = false;
+      for (LogSlot *slot = &slots[head % LOG_CAPACITY];
+           slot->sequence.load(std::memory_order_acquire) == head + 1;
+           slot = &slots[head % LOG_CAPACITY]) {
+        file.write(slot->text, slot->length);
+        file.put('\n');
+        slot->sequence.store(head + LOG_CAPACITY, std::memory_order_release);
+        head++;
+        wrote = true;
+      }
+      uint64_t n_dropped_now = n_dropped.load(std::memory_order_relaxed);
+      if (n_dropped_now != n_reported_dropped) {
+        file << "-- " << n_dropped_now - n_reported_dropped
+             << " log lines dropped --\n";
+        n_reported_dropped = n_dropped_now;
+        wrote = true;
+      }
+      if (wrote) {
+        file.flush();
+      }
+
+      if (stop_after_batch) {
+        return;
+      }
+      n_published.wait(published, std::memory_order_acquire);
+    }
+  }
+
+  std::unique_ptr<LogSlot[]> slots;
+  std::atomic<uint64_t> tail = 0;
+  // Incremented after each line is queued, for the consumer to wait on.
+  std::atomic<uint64_t> n_published = 0;
+  std::atomic<uint64_t> n_dropped = 0;
+  std::atomic<LogLevel> level = LOG_OFF;
+
+  std::mutex path_mutex;
+  std::string path = "venus.log";
+  bool reopen = true;
+
+  std::mutex thread_mutex;
+  std::thread thread;
+  std::atomic<bool> stopping = false;
+};
+
+/** Returns the logger, which is stopped at exit.
+ *
+ * @return Logger.
+ */
+AsyncLogger &getLogger(void) {
+  static AsyncLogger logger;
+  return logger;
+}
+
+void setLogLevel(LogLevel level) { getLogger().setLevel(level); }
+
+void setLogFile(const std::string &path) { getLogger().setPath(path); }
+
+void writeToLog(std::string_view line, LogLevel level) {
+  AsyncLogger &logger = getLogger();
+  if (level != LOG_OFF && level <= logger.getLevel()) {
+    logger.push("", line);
+  }
+}
+
+void printAndWriteToLog(std::string_view line, LogLevel level) {
+  std::cout << line << '\n';
+  AsyncLogger &logger = getLogger();
+  if (level != LOG_OFF && level <= logger.getLevel()) {
+    logger.push("<< ", line);
+  }
+}
+
+void flushOutput(void) { std::cout.flush(); }
+
+void stopLogger(void) { getLogger().stop(); }
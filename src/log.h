@@ -1,22 +1,54 @@
+#pragma once
 
+#include <stdint.h>
 #include <string>
-#include <fstream>
-#include <ostream>
+#include <string_view>
 
-std::string fp_log = "/Users/daviddoellstedt/Documents/GitHub/venus_chess/log1.txt";
-bool logging = false;
+enum LogLevel : uint8_t {
+  LOG_OFF = 0,
+  LOG_ERROR = 1,
+  LOG_INFO = 2,
+  LOG_DEBUG = 3
+};
 
-/** Prints input to std out and to a log file. Useful for debugging UCI GUIs.
+/** Sets the level of the lines written to the log file. The log file is only
+ * opened, and the flush thread only started, once the level is not LOG_OFF.
  *
- * @param str: Test to print and log.
+ * @param level: Log level.
  */
-void printAndWriteToLog(std::string str) {
-  if (logging) {
-    std::ofstream outfile;
-    outfile.open(fp_log, std::ios_base::app);
-    outfile << "<< " << str << "\n";
-    outfile.close();
-  }
-
-  std::cout << str << std::endl;
-}
+void setLogLevel(LogLevel level);
+
+/** Sets the path of the log file, which is appended to. The lines already
+ * queued are written to the new file.
+ *
+ * @param path: Path of the log file.
+ */
+void setLogFile(const std::string &path);
+
+/** Queues a line for the log file, if the log level includes it. Never blocks
+ * or allocates: the line is copied into a lock-free ring buffer, which a
+ * background thread writes to the file. Lines longer than a ring buffer slot
+ * are truncated, and lines are dropped (and counted in the log) if the ring
+ * buffer is full.
+ *
+ * @param line: Line to log.
+ * @param level: Log level of the line.
+ */
+void writeToLog(std::string_view line, LogLevel level);
+
+/** Prints a line of engine output to std out and logs it. The output is
+ * buffered until flushOutput().
+ *
+ * @param line: Line to print and log.
+ * @param level: Log level of the line.
+ */
+void printAndWriteToLog(std::string_view line, LogLevel level = LOG_INFO);
+
+/** Flushes the engine output. Called at protocol boundaries, once the reply
+ * to a command is complete.
+ */
+void flushOutput(void);
+
+/** Writes out the queued lines and stops the flush thread. Also done at exit.
+ */
+void stopLogger(void);
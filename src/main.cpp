@@ -1,12 +1,112 @@
 #include "../test/test.h"
-#include "evaluate.h"
+#include "analysis.h"
+#include "bench.h"
+#include "constants.h"
 #include "move_generator.h"
+#include "packed_position.h"
+#include "perft.h"
+#include "search.h"
+#include "tune.h"
 #include "uci.h"
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+/** Parses a numeric command line argument.
+ *
+ * @param text: Argument.
+ * @param min: Minimum value.
+ * @param max: Maximum value.
+ * @param value: Value, populated by this function.
+ * @return True if the argument is a number in range.
+ */
+bool parseArgument(std::string_view text, int64_t min, int64_t max,
+                   int64_t &value) {
+  auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() && end == text.data() + text.size() &&
+         value >= min && value <= max;
+}
+
+int main(int argc, char *argv[]) {
+  // Command line modes, for benchmarking, perft, tuning, packing positions,
+  // batch analysis and generating the magic numbers. Defaults to a UCI
+  // session.
+  if (argc > 1 && std::string(argv[1]) == "bench") {
+    runBenchmark(argc > 2 ? std::stoi(argv[2]) : 5);
+    return 0;
+  }
+  if (argc > 2 &&
+      (std::string(argv[1]) == "perft" || std::string(argv[1]) == "divide")) {
+    // The FEN may be passed as one argument or as separate fields.
+    std::string fen;
+    for (int i = 5; i < argc; i++) {
+      fen += (i > 5 ? " " : "") + std::string(argv[i]);
+    }
+    int64_t depth;
+    int64_t hash_mb = 0;
+    int64_t n_threads = 1;
+    if (!parseArgument(argv[2], 1, UINT8_MAX, depth) ||
+        (argc > 3 && !parseArgument(argv[3], 0, 65536, hash_mb)) ||
+        (argc > 4 && !parseArgument(argv[4], 1, 256, n_threads))) {
+      std::cout << "Usage: " << argv[1]
+                << " <depth 1-255> [hash_mb 0-65536] [threads 1-256] [fen]"
+                << std::endl;
+      return 1;
+    }
+    runPerft(fen.empty() ? fen_standard : fen, depth, hash_mb, n_threads,
+             std::string(argv[1]) == "divide");
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "test") {
+    testAllPerft();
+    testMoveValidation();
+    testFenParsing();
+    testPackedPositions();
+    testEpdLoading();
+    testBatchAnalysis();
+    testUCIPosition();
+    testUCIOptions();
+    testAsyncLogger();
+    return 0;
+  }
+  if (argc > 2 && std::string(argv[1]) == "tune") {
+    runTuning(argv[2], argc > 3 ? std::stoi(argv[3]) : 1000,
+              argc > 4 ? argv[4] : "evaluation_parameters.h");
+    return 0;
+  }
+  if (argc > 3 && std::string(argv[1]) == "pack") {
+    packPositionFile(argv[2], argv[3]);
+    return 0;
+  }
+  if (argc > 2 && std::string(argv[1]) == "analyze") {
+    int64_t depth;
+    int64_t n_threads = 1;
+    if (!parseArgument(argv[2], 1, MAX_SEARCH_DEPTH, depth) ||
+        (argc > 3 && !parseArgument(argv[3], 1, 256, n_threads))) {
+      std::cout << "Usage: analyze <depth 1-" << (int)MAX_SEARCH_DEPTH
+                << "> [threads 1-256] [input_file]" << std::endl;
+      return 1;
+    }
+    // Reads the positions from stdin, unless a file is given.
+    std::ifstream file;
+    if (argc > 4) {
+      file.open(argv[4]);
+      if (!file) {
+        std::cout << "Could not open " << argv[4] << "." << std::endl;
+        return 1;
+      }
+    }
+    runBatchAnalysis(argc > 4 ? file : std::cin, depth, n_threads);
+    return 0;
+  }
+  if (argc > 1 && std::string(argv[1]) == "magics") {
+    printMagicNumbers();
+    return 0;
+  }
 
-int main() {
-  initializeMagicBitboardTables();
-  initializePositionTables();
-  // testAllPerft();
   UCIStart();
   return 0;
 }
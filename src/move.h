@@ -5,11 +5,10 @@
 #include <string>
 
 // Masks for reading/writing to move.
-const uint16_t X_INITIAL_MASK = 0x7;
-const uint16_t Y_INITIAL_MASK = 0x38;
-const uint16_t X_FINAL_MASK = 0x1C0;
-const uint16_t Y_FINAL_MASK = 0xE00;
-const uint16_t MOVE_TYPE_MASK = 0xF000;
+const uint16_t FROM_SQUARE_MASK = 0x3F;
+const uint16_t TO_SQUARE_MASK = 0xFC0;
+const uint16_t MOVE_TYPE_MASK = 0x7000;
+const uint16_t CAPTURE_MASK = 0x8000;
 
 enum MoveType : uint8_t {
   NONE = 0,
@@ -24,21 +23,14 @@ enum MoveType : uint8_t {
 
 class Move {
 private:
-  /**Moves are stored as a 16-bit integer. Kept as lightweight as possible to
-   * allow deeper search. Bits: 0 - 2:   Initial x position 3 - 5:   Initial y
-   * position 6 - 8:   Final x position 9 - 11:  Final y position 12 - 15:
-   * move type (see MoveType enum).
+  /** Moves are stored as a 16-bit integer. Kept as lightweight as possible to
+   * allow deeper search. Bits: 0 - 5: initial square, 6 - 11: final square,
+   * 12 - 14: move type (see MoveType enum), 15: capture flag (set for en
+   * passant too).
    */
   uint16_t data = 0;
-  void setX1(uint8_t x1) { data |= x1; }
-  void setY1(uint8_t y1) { data |= y1 << 3; }
-  void setX2(uint8_t x2) { data |= x2 << 6; }
-  void setY2(uint8_t y2) { data |= y2 << 9; }
-  std::string moveTypeToString(void) {
+  std::string moveTypeToString(void) const {
     switch (getMoveType()) {
-    case NONE:
-    case PAWN_PUSH_2:
-      return "";
     case PROMOTION_QUEEN:
       return "q";
     case PROMOTION_ROOK:
@@ -51,38 +43,51 @@ private:
       return "";
     }
   }
+  static std::string squareToString(uint8_t square) {
+    return std::string(1, 'a' + square % 8) + std::to_string(square / 8 + 1);
+  }
 
 public:
-  uint8_t getX1(void) { return data & X_INITIAL_MASK; }
-  uint8_t getY1(void) { return (data & Y_INITIAL_MASK) >> 3; }
-  uint8_t getX2(void) { return (data & X_FINAL_MASK) >> 6; }
-  uint8_t getY2(void) { return (data & Y_FINAL_MASK) >> 9; }
-  uint64_t getInitialBitboard(void) { return 1ULL << (getX1() * 8 + getY1()); }
-  uint64_t getFinalBitboard(void) { return 1ULL << (getX2() * 8 + getY2()); }
-  MoveType getMoveType(void) {
+  uint8_t getFrom(void) const { return data & FROM_SQUARE_MASK; }
+  uint8_t getTo(void) const { return (data & TO_SQUARE_MASK) >> 6; }
+  uint64_t getInitialBitboard(void) const { return 1ULL << getFrom(); }
+  uint64_t getFinalBitboard(void) const { return 1ULL << getTo(); }
+  MoveType getMoveType(void) const {
     return (MoveType)((data & MOVE_TYPE_MASK) >> 12);
   }
   void setMoveType(MoveType move_type) {
     data &= ~MOVE_TYPE_MASK;
     data |= move_type << 12;
   }
-  std::string toString(void) {
-    return (char)('a' + getY1()) + std::to_string(getX1() + 1) +
-           (char)('a' + getY2()) + std::to_string(getX2() + 1) +
-           moveTypeToString();
+  bool isCapture(void) const { return data & CAPTURE_MASK; }
+  void setCapture(bool capture) {
+    data = capture ? data | CAPTURE_MASK : data & ~CAPTURE_MASK;
   }
-  Move() {};
-  Move(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, MoveType move_type) {
-    setX1(x1);
-    setY1(y1);
-    setX2(x2);
-    setY2(y2);
-    setMoveType(move_type);
+  bool isPromotion(void) const {
+    return getMoveType() >= PROMOTION_QUEEN &&
+           getMoveType() <= PROMOTION_BISHOP;
+  }
+  uint16_t getData(void) const { return data; }
+  static Move fromData(uint16_t data) {
+    Move move;
+    move.data = data;
+    return move;
   }
-  Move(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
-    setX1(x1);
-    setY1(y1);
-    setX2(x2);
-    setY2(y2);
+  bool operator==(const Move &move) const { return data == move.data; }
+  std::string toString(void) const {
+    return squareToString(getFrom()) + squareToString(getTo()) +
+           moveTypeToString();
   }
+  Move() {};
+  Move(uint8_t from, uint8_t to, MoveType move_type = NONE,
+       bool capture = false)
+      : data(from | to << 6 | move_type << 12 | capture << 15) {}
 };
+
+/** Move list entry with a score, for move ordering. */
+struct ScoredMove {
+  Move move;
+  int16_t score = 0;
+};
+
+static_assert(sizeof(Move) == 2 && sizeof(ScoredMove) == 4);
@@ -2,32 +2,14 @@
 #include "constants.h"
 #include "helper_functions.h"
 #include "move.h"
+#include "move_generator.h"
 
+#include <array>
+#include <cstring>
 #include <iostream>
+#include <random>
 #include <stdint.h>
-
-uint64_t bishopMagicTable[N_SQUARES][N_BISHOP_BLOCKERS_PERMUTATIONS] = {0};
-uint64_t rookMagicTable[N_SQUARES][N_ROOK_BLOCKERS_PERMUTATIONS] = {0};
-
-/** Returns a bitboard of the line between two pieces.
- *
- * @param p1: First piece bitboard.
- * @param p2: Second piece bitboard.
- * @return Bitboard mask of rank/file/diagonal connection between the two
- * pieces.
- */
-uint64_t getColinearMask(uint64_t p1, uint64_t p2) {
-  uint8_t k_bit = getSetBit(p2);
-  uint8_t p_bit = getSetBit(p1);
-
-  for (uint8_t dir = 0; dir < N_DIRECTIONS; dir++) {
-    if (directional_mask[k_bit][dir] == directional_mask[p_bit][dir]) {
-      return directional_mask[k_bit][dir];
-    }
-  }
-  logErrorAndExit("ERROR: The two arguments provided are not colinear.");
-  return 0;
-}
+#include <vector>
 
 /** Gets the horizontal moves a slider piece can make, using setwise operations.
  * https://www.chessprogramming.org/General_Setwise_Operations.
@@ -36,7 +18,8 @@ uint64_t getColinearMask(uint64_t p1, uint64_t p2) {
  * @param occupied: Bitboard of occupied spaces on the board.
  * @return Bitboard of horizontal moves.
  */
-uint64_t getSetwiseHorizontalMoves(uint64_t piece, uint64_t occupied) {
+constexpr uint64_t getSetwiseHorizontalMoves(uint64_t piece,
+                                             uint64_t occupied) {
   uint64_t horiz_moves = (((occupied)-2 * piece) ^
                           reverse(reverse(occupied) - 2 * reverse(piece))) &
                          directional_mask[getSetBit(piece)][RANKS];
@@ -50,7 +33,7 @@ uint64_t getSetwiseHorizontalMoves(uint64_t piece, uint64_t occupied) {
  * @param occupied: Bitboard of occupied spaces on the board.
  * @return Bitboard of vertical moves.
  */
-uint64_t getSetwiseVerticalMoves(uint64_t piece, uint64_t occupied) {
+constexpr uint64_t getSetwiseVerticalMoves(uint64_t piece, uint64_t occupied) {
   uint8_t sl_bit = getSetBit(piece);
   uint64_t vert_moves =
       (((occupied & directional_mask[sl_bit][FILES]) - 2 * piece) ^
@@ -72,9 +55,9 @@ uint64_t getSetwiseVerticalMoves(uint64_t piece, uint64_t occupied) {
  * details).
  * @return Bitboard of horizontal/vertical moves.
  */
-uint64_t getSetwiseHorizontalAndVerticalMoves(uint64_t piece, uint64_t occupied,
-                                              bool unsafe_calculation = false,
-                                              uint64_t K = 0) {
+constexpr uint64_t getSetwiseHorizontalAndVerticalMoves(
+    uint64_t piece, uint64_t occupied, bool unsafe_calculation = false,
+    uint64_t K = 0) {
   /** Used in the case where we need to generate zones for the king that are
    * unsafe. If the king is in the attack zone of a horizontal/vertical slider,
    * we want to remove the king from the occupied zone. Because a move of the
@@ -94,7 +77,8 @@ uint64_t getSetwiseHorizontalAndVerticalMoves(uint64_t piece, uint64_t occupied,
  * @param occupied: Bitboard of occupied spaces on the board.
  * @return Bitboard of down right diagonal moves.
  */
-uint64_t getSetwiseDownRightDiagonalMoves(uint64_t piece, uint64_t occupied) {
+constexpr uint64_t getSetwiseDownRightDiagonalMoves(uint64_t piece,
+                                                    uint64_t occupied) {
   uint8_t sl_bit = getSetBit(piece);
   uint64_t ddr_moves =
       (((occupied & directional_mask[sl_bit][DIAGONALS_DOWN_RIGHT]) -
@@ -113,7 +97,8 @@ uint64_t getSetwiseDownRightDiagonalMoves(uint64_t piece, uint64_t occupied) {
  * @param occupied: Bitboard of occupied spaces on the board.
  * @return Bitboard of up right diagonal moves.
  */
-uint64_t getSetwiseUpRightDiagonalMoves(uint64_t piece, uint64_t occupied) {
+constexpr uint64_t getSetwiseUpRightDiagonalMoves(uint64_t piece,
+                                                  uint64_t occupied) {
   uint8_t sl_bit = getSetBit(piece);
   uint64_t dur_moves =
       (((occupied & directional_mask[sl_bit][DIAGONALS_UP_RIGHT]) - 2 * piece) ^
@@ -134,9 +119,9 @@ uint64_t getSetwiseUpRightDiagonalMoves(uint64_t piece, uint64_t occupied) {
  * details).
  * @return Bitboard of diagonal moves.
  */
-uint64_t getSetwiseDiagonalMoves(uint64_t piece, uint64_t occupied,
-                                 bool unsafe_calculation = false,
-                                 uint64_t K = 0) {
+constexpr uint64_t getSetwiseDiagonalMoves(uint64_t piece, uint64_t occupied,
+                                           bool unsafe_calculation = false,
+                                           uint64_t K = 0) {
 
   /** Used in the case where we need to generate zones for the king that are
    * unsafe. If the king is in the attack zone of a horizontal/vertical slider,
@@ -150,222 +135,222 @@ uint64_t getSetwiseDiagonalMoves(uint64_t piece, uint64_t occupied,
          getSetwiseUpRightDiagonalMoves(piece, occupied);
 }
 
-/** Finds a rook magic number for a specific bit.
+/** Returns the moves of a slider piece, using setwise operations.
  *
- * @param bit: Square/bit on the board to do the search for.
- * @param blockers_array: Rook blockers array.
- * @return Magic number, if found, else 0.
+ * @param bit: Square/bit of the slider piece.
+ * @param blockers: Bitboard of the blockers.
+ * @param diagonal: True for bishop moves, false for rook moves.
+ * @return Bitboard of moves.
  */
-uint64_t generateRookMagicNumber(
-    uint8_t bit,
-    uint64_t blockers_array[N_SQUARES][N_ROOK_BLOCKERS_PERMUTATIONS]) {
-  uint64_t rookMagicTableTemp[N_ROOK_BLOCKERS_PERMUTATIONS] = {0};
-
-  while (true) {
-    // Sparse bits produce much better magic number candidates.
-    uint64_t magic_num =
-        generateRandom64() & generateRandom64() & generateRandom64();
-
-    if (countSetBits((magic_num * rook_magic_masks[bit]) &
-                     0xFF00000000000000ull) < 6) {
-      continue;
-    }
-
-    bool fail = false;
-    uint64_t i;
-    for (i = 0; i < N_ROOK_BLOCKERS_PERMUTATIONS; i++) {
-      uint64_t blockers = blockers_array[bit][i];
-      uint64_t magic_product = blockers * magic_num;
-      uint16_t index = magic_product >> 52;
-
-      uint64_t h_v_moves =
-          getSetwiseHorizontalAndVerticalMoves(1ull << bit, blockers);
-
-      if (rookMagicTableTemp[index] == 0) {
-        rookMagicTableTemp[index] = h_v_moves;
-        continue;
-      }
-      // There is already an entry, but we are lucky and it matches, continue;
-      if (h_v_moves == rookMagicTableTemp[index]) {
-        // std::cout << " HEY HEY HEY" << std::endl;
-        continue;
-      }
-      // Else there is a conflict. Clear the table and try the next magic number
-      memset(rookMagicTableTemp, 0,
-             N_ROOK_BLOCKERS_PERMUTATIONS * sizeof(uint64_t));
-      fail = true;
-      break;
-    }
-    if (!fail) {
-      return magic_num;
-    }
-  }
-  return 0;
+constexpr uint64_t getSetwiseSliderMoves(uint8_t bit, uint64_t blockers,
+                                         bool diagonal) {
+  return diagonal
+             ? getSetwiseDiagonalMoves(1ULL << bit, blockers)
+             : getSetwiseHorizontalAndVerticalMoves(1ULL << bit, blockers);
 }
 
-/** Finds a bishop magic number for a specific bit.
+/** Finds a magic number for a specific bit. The magic number maps every
+ * blockers permutation to an index with as many bits as there are relevant
+ * blockers, and collisions are only allowed between permutations with the same
+ * moves.
  *
  * @param bit: Square/bit on the board to do the search for.
- * @param blockers_array: Bishop blockers array.
- * @return Magic number, if found, else 0.
+ * @param mask: Relevant blockers mask of the square.
+ * @param diagonal: True for bishop moves, false for rook moves.
+ * @param generator: Random number generator.
+ * @return Magic number.
  */
-uint64_t generateBishopMagicNumber(
-    uint8_t bit,
-    uint64_t blockers_array[N_SQUARES][N_BISHOP_BLOCKERS_PERMUTATIONS]) {
-  uint64_t bishopMagicTableTemp[N_BISHOP_BLOCKERS_PERMUTATIONS] = {0};
-
-  while (true) {
+uint64_t findMagicNumber(uint8_t bit, uint64_t mask, bool diagonal,
+                         std::mt19937_64 &generator) {
+  uint8_t n_bits = countSetBits(mask);
+  std::vector<uint64_t> blockers;
+  std::vector<uint64_t> moves;
+  uint64_t blockers_bitboard = 0;
+  do {
+    blockers.push_back(blockers_bitboard);
+    moves.push_back(getSetwiseSliderMoves(bit, blockers_bitboard, diagonal));
+    blockers_bitboard = (blockers_bitboard - mask) & mask;
+  } while (blockers_bitboard);
+
+  // Entries are only valid if written during the current attempt, so the table
+  // does not need clearing between attempts.
+  std::vector<uint64_t> table(1 << n_bits);
+  std::vector<uint32_t> table_attempt(1 << n_bits, 0);
+  for (uint32_t attempt = 1;; attempt++) {
     // Sparse bits produce much better magic number candidates.
-    uint64_t magic_num =
-        generateRandom64() & generateRandom64() & generateRandom64();
-
-    if (countSetBits((magic_num * bishop_magic_masks[bit]) &
-                     0xFF00000000000000ull) < 6) {
+    uint64_t magic_number = generator() & generator() & generator();
+    if (countSetBits((magic_number * mask) & 0xFF00000000000000ULL) < 6) {
       continue;
     }
 
     bool fail = false;
-    uint64_t i;
-    for (i = 0; i < N_BISHOP_BLOCKERS_PERMUTATIONS; i++) {
-      uint64_t blockers = blockers_array[bit][i];
-      uint64_t magic_product = blockers * magic_num;
-      uint16_t index = magic_product >> (64 - N_BISHOP_BLOCKERS);
-      uint64_t diag_moves = getSetwiseDiagonalMoves(1ull << bit, blockers);
-
-      if (bishopMagicTableTemp[index] == 0) {
-        bishopMagicTableTemp[index] = diag_moves;
-        continue;
+    for (uint32_t i = 0; i < blockers.size() && !fail; i++) {
+      uint32_t index = (blockers[i] * magic_number) >> (64 - n_bits);
+      if (table_attempt[index] != attempt) {
+        table_attempt[index] = attempt;
+        table[index] = moves[i];
+      } else if (table[index] != moves[i]) {
+        fail = true;
       }
-      // There is already an entry, but we are lucky and it matches, continue;
-      if (diag_moves == bishopMagicTableTemp[index]) {
-        continue;
-      }
-      // Else there is a conflict. Clear the table and try the next magic number
-      memset(bishopMagicTableTemp, 0,
-             N_BISHOP_BLOCKERS_PERMUTATIONS * sizeof(uint64_t));
-      fail = true;
-      break;
     }
     if (!fail) {
-      return magic_num;
+      return magic_number;
     }
   }
-  return 0;
 }
 
-/** Populates the global magic rook table used for generating
- * horizontal/vertical moves.
+/** Prints the magic numbers of a slider piece type, as a C++ array.
  *
- * @param blockers_array: Rook blockers array.
+ * @param name: Name of the array.
+ * @param masks: Relevant blockers mask for each square.
+ * @param diagonal: True for bishop moves, false for rook moves.
+ * @param generator: Random number generator.
  */
-void initializeRookMagicTable(
-    uint64_t blockers_array[N_SQUARES][N_ROOK_BLOCKERS_PERMUTATIONS]) {
+void printMagicNumberArray(const std::string &name,
+                           const uint64_t (&masks)[N_SQUARES], bool diagonal,
+                           std::mt19937_64 &generator) {
+  std::cout << "constexpr uint64_t " << name << "[N_SQUARES] = {";
   for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
-    uint64_t magic_number = rook_magic_numbers[bit];
-    for (uint16_t blockers_index = 0;
-         blockers_index < N_ROOK_BLOCKERS_PERMUTATIONS; blockers_index++) {
-      uint64_t blockers_bitboard = blockers_array[bit][blockers_index];
-      rookMagicTable[bit][(magic_number * blockers_bitboard) >>
-                          (64 - N_ROOK_BLOCKERS)] =
-          getSetwiseHorizontalAndVerticalMoves(1ULL << bit, blockers_bitboard);
-    }
+    std::cout << (bit % 3 == 0 ? "\n    " : " ") << "0x" << std::hex
+              << std::uppercase
+              << findMagicNumber(bit, masks[bit], diagonal, generator)
+              << std::dec << (bit < N_SQUARES - 1 ? "," : "};\n");
   }
 }
 
-/** Populates the global magic bishop table used for generating diagonal moves.
- *
- * @param blockers_array: Bishop blockers array.
- */
-void initializeBishopMagicTable(
-    uint64_t blockers_array[N_SQUARES][N_BISHOP_BLOCKERS_PERMUTATIONS]) {
-  for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
-    uint64_t magic_number = bishop_magic_numbers[bit];
-    for (uint16_t blockers_index = 0;
-         blockers_index < N_BISHOP_BLOCKERS_PERMUTATIONS; blockers_index++) {
-      uint64_t blockers_bitboard = blockers_array[bit][blockers_index];
-      bishopMagicTable[bit][(magic_number * blockers_bitboard) >>
-                            (64 - N_BISHOP_BLOCKERS)] =
-          getSetwiseDiagonalMoves(1ULL << bit, blockers_bitboard);
-    }
-  }
+void printMagicNumbers(void) {
+  std::mt19937_64 generator(std::random_device{}());
+  printMagicNumberArray("bishop_magic_numbers", bishop_magic_masks, true,
+                        generator);
+  printMagicNumberArray("rook_magic_numbers", rook_magic_masks, false,
+                        generator);
 }
 
-/** Generates a blockers bitboard from the respective blocker index.
+// Lookup data of a slider piece type on a square. Aligned so an entry never
+// straddles two cache lines.
+struct alignas(32) SliderMagic {
+  // Relevant blockers mask.
+  uint64_t mask;
+
+  uint64_t magic_number;
+
+  // Index of the square's first entry in the slider tables.
+  uint32_t offset;
+
+  // 64 - number of relevant blockers.
+  uint8_t shift;
+};
+
+/** Returns the number of entries of a slider piece type in the slider tables.
+ * One entry per blockers permutation of every square.
  *
- * @param blocker_index: Blocker index. Each set bit represents a blocker.
- * @param all_blockers: Bitboard of all possible blockers.
- * @return Bitboard of blockers.
+ * @param masks: Relevant blockers mask for each square.
+ * @return Number of entries.
  */
-uint64_t generateBlockersBitboardFromIndex(uint16_t blocker_index,
-                                           uint64_t all_blockers) {
-  uint64_t blockers_bitboard = all_blockers;
-  uint8_t i_blocker = 0;
-  while (all_blockers) {
-    uint64_t blocker_bb = getLowestSetBitValue(all_blockers);
-    uint8_t blocker_bit = getSetBit(blocker_bb);
-
-    // Check if we need to clear the blocker bit.
-    if (!(blocker_index & (1 << i_blocker))) {
-      blockers_bitboard &= ~(1ull << blocker_bit);
-    }
-    clearLowestSetBit(all_blockers);
-    i_blocker++;
+constexpr uint32_t countSliderTableEntries(const uint64_t (&masks)[N_SQUARES]) {
+  uint32_t n_entries = 0;
+  for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
+    n_entries += 1 << countSetBits(masks[bit]);
   }
-  return blockers_bitboard;
+  return n_entries;
 }
 
-/** Initializes the rook blockers array.
+/** Generates the lookup data of a slider piece type. The squares are stored
+ * one after another in the slider tables, each with just as many entries as it
+ * needs.
  *
- * @param blockers_array: Rook blockers array.
+ * @param masks: Relevant blockers mask for each square.
+ * @param magic_numbers: Magic number for each square.
+ * @param first_offset: Index of the piece type's first entry.
+ * @return Lookup data, indexed by square.
  */
-void initializeRookBlockers(
-    uint64_t blockers_array[N_SQUARES][N_ROOK_BLOCKERS_PERMUTATIONS]) {
+constexpr std::array<SliderMagic, N_SQUARES>
+generateSliderMagics(const uint64_t (&masks)[N_SQUARES],
+                     const uint64_t (&magic_numbers)[N_SQUARES],
+                     uint32_t first_offset) {
+  std::array<SliderMagic, N_SQUARES> magics{};
+  uint32_t offset = first_offset;
   for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
-    for (uint16_t blocker_index = 0;
-         blocker_index < N_ROOK_BLOCKERS_PERMUTATIONS; blocker_index++) {
-      uint64_t blockers_bitboard = generateBlockersBitboardFromIndex(
-          blocker_index, rook_magic_masks[bit]);
-      blockers_array[bit][blocker_index] = blockers_bitboard;
-    }
+    uint8_t n_bits = countSetBits(masks[bit]);
+    magics[bit] = {masks[bit], magic_numbers[bit], offset,
+                   uint8_t(64 - n_bits)};
+    offset += 1 << n_bits;
   }
+  return magics;
 }
 
-/** Initializes the bishop blockers array.
+// Rooks come first in the slider tables, followed by bishops.
+constexpr uint32_t N_ROOK_TABLE_ENTRIES =
+    countSliderTableEntries(rook_magic_masks);
+constexpr uint32_t N_SLIDER_TABLE_ENTRIES =
+    N_ROOK_TABLE_ENTRIES + countSliderTableEntries(bishop_magic_masks);
+
+constexpr std::array<SliderMagic, N_SQUARES> rook_magics =
+    generateSliderMagics(rook_magic_masks, rook_magic_numbers, 0);
+constexpr std::array<SliderMagic, N_SQUARES> bishop_magics =
+    generateSliderMagics(bishop_magic_masks, bishop_magic_numbers,
+                         N_ROOK_TABLE_ENTRIES);
+
+/** Generates a slider table at compile time. Every blockers permutation of
+ * every square is indexed, and the respective slider moves are stored at the
+ * resulting index.
  *
- * @param blockers_array: Bishop blockers array.
+ * @param pext: If true, indexed by PEXT of the blockers. The carry-rippler
+ * walks the subsets of the mask in increasing order of their PEXT index, so the
+ * index is just the iteration count. Else indexed by the magic number hash.
+ * @return Slider table.
  */
-void initializeBishopBlockers(
-    uint64_t blockers_array[N_SQUARES][N_BISHOP_BLOCKERS_PERMUTATIONS]) {
-  for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
-    for (uint16_t blocker_index = 0;
-         blocker_index < N_BISHOP_BLOCKERS_PERMUTATIONS; blocker_index++) {
-      uint64_t blockers_bitboard = generateBlockersBitboardFromIndex(
-          blocker_index, bishop_magic_masks[bit]);
-      blockers_array[bit][blocker_index] = blockers_bitboard;
+constexpr std::array<uint64_t, N_SLIDER_TABLE_ENTRIES>
+generateSliderTable(bool pext) {
+  std::array<uint64_t, N_SLIDER_TABLE_ENTRIES> table{};
+  for (bool diagonal : {false, true}) {
+    const std::array<SliderMagic, N_SQUARES> &magics =
+        diagonal ? bishop_magics : rook_magics;
+    for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
+      const SliderMagic &magic = magics[bit];
+      uint64_t blockers_bitboard = 0;
+      uint32_t pext_index = 0;
+      do {
+        uint32_t index =
+            magic.offset +
+            (pext ? pext_index++
+                  : (blockers_bitboard * magic.magic_number) >> magic.shift);
+        uint64_t moves =
+            getSetwiseSliderMoves(bit, blockers_bitboard, diagonal);
+        // Slider moves are never empty, so a different non-empty entry is a
+        // destructive collision. Throwing stops the compilation.
+        if (table[index] && table[index] != moves) {
+          throw "Invalid magic number, regenerate them with the magics mode.";
+        }
+        table[index] = moves;
+        blockers_bitboard = (blockers_bitboard - magic.mask) & magic.mask;
+      } while (blockers_bitboard);
     }
   }
+  return table;
 }
 
-/** Initializes the bishop magic bitboard table.
- */
-void initializeBishopMagicBitboardTable(void) {
-  uint64_t bishop_blockers[N_SQUARES][N_BISHOP_BLOCKERS_PERMUTATIONS];
-  initializeBishopBlockers(bishop_blockers);
-  initializeBishopMagicTable(bishop_blockers);
-}
-
-/** Initializes the rook magic bitboard table.
- */
-void initializeRookMagicBitboardTable(void) {
-  uint64_t rook_blockers[N_SQUARES][N_ROOK_BLOCKERS_PERMUTATIONS];
-  initializeRookBlockers(rook_blockers);
-  initializeRookMagicTable(rook_blockers);
+// Slider tables used for generating slider moves, one per backend. Built at
+// compile time, so they live in read-only memory and need no startup
+// initialization.
+constexpr std::array<uint64_t, N_SLIDER_TABLE_ENTRIES> magic_slider_table =
+    generateSliderTable(false);
+constexpr std::array<uint64_t, N_SLIDER_TABLE_ENTRIES> pext_slider_table =
+    generateSliderTable(true);
+
+// Backend of the slider lookups, picked once at startup.
+SliderBackend slider_backend =
+    cpuSupportsFastPext() ? PEXT_BACKEND : MAGIC_BACKEND;
+
+bool setSliderBackend(SliderBackend backend) {
+  if (backend == PEXT_BACKEND && !cpuSupportsFastPext()) {
+    return false;
+  }
+  slider_backend = backend;
+  return true;
 }
 
-void initializeMagicBitboardTables(void) {
-  initializeBishopMagicBitboardTable();
-  initializeRookMagicBitboardTable();
-}
+SliderBackend getSliderBackend(void) { return slider_backend; }
 
 /** Generates horizontal/vertical moves. For pieces such as rook/queen.
  *
@@ -381,12 +366,15 @@ uint64_t horizontalAndVerticalMoves(uint64_t piece, uint64_t OCCUPIED,
   if (unsafe_calculation) {
     OCCUPIED &= ~K;
   }
-  uint8_t piece_bit = getSetBit(piece);
-  uint64_t blockers = OCCUPIED &= rook_magic_masks[piece_bit];
-  uint64_t magic_moves =
-      rookMagicTable[piece_bit][(blockers * rook_magic_numbers[piece_bit]) >>
-                                (64 - N_ROOK_BLOCKERS)];
-  return magic_moves;
+  const SliderMagic &magic = rook_magics[getSetBit(piece)];
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+  if (slider_backend == PEXT_BACKEND) {
+    return pext_slider_table[magic.offset + extractBits(OCCUPIED, magic.mask)];
+  }
+#endif
+  return magic_slider_table[magic.offset +
+                            (((OCCUPIED & magic.mask) * magic.magic_number) >>
+                             magic.shift)];
 }
 
 /** Generates diagonal moves. For pieces such as bishop/queen.
@@ -402,13 +390,35 @@ uint64_t diagonalMoves(uint64_t piece, uint64_t OCCUPIED,
   if (unsafe_calculation) {
     OCCUPIED &= ~K;
   }
-  uint8_t piece_bit = getSetBit(piece);
-  uint64_t blockers = OCCUPIED &= bishop_magic_masks[piece_bit];
-  uint64_t magic_moves =
-      bishopMagicTable[piece_bit]
-                      [(blockers * bishop_magic_numbers[piece_bit]) >>
-                       (64 - N_BISHOP_BLOCKERS)];
-  return magic_moves;
+  const SliderMagic &magic = bishop_magics[getSetBit(piece)];
+#ifdef HAS_X86_TARGET_ATTRIBUTES
+  if (slider_backend == PEXT_BACKEND) {
+    return pext_slider_table[magic.offset + extractBits(OCCUPIED, magic.mask)];
+  }
+#endif
+  return magic_slider_table[magic.offset +
+                            (((OCCUPIED & magic.mask) * magic.magic_number) >>
+                             magic.shift)];
+}
+
+/** Adds the moves from the square to each of the target squares to the move
+ * list.
+ *
+ * @param from: Initial square.
+ * @param targets: Bitboard of the target squares.
+ * @param OCCUPIED: Bitboard of all the occupied spaces on the board, to flag
+ * captures.
+ * @param moves: Move list.
+ * @param n_moves: Running total number of moves.
+ */
+inline void addMoves(uint8_t from, uint64_t targets, uint64_t OCCUPIED,
+                     Move *moves, uint8_t &n_moves) {
+  while (targets) {
+    uint64_t bb_final = getLowestSetBitValue(targets);
+    moves[n_moves++] =
+        Move(from, getSetBit(bb_final), NONE, bb_final & OCCUPIED);
+    clearLowestSetBit(targets);
+  }
 }
 
 /** Generates and adds rook moves to the move list.
@@ -418,33 +428,23 @@ uint64_t diagonalMoves(uint64_t piece, uint64_t OCCUPIED,
  * @param PIECES: Bitboard of the active player's pieces.
  * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
  * @param PINNED: Bitboard of pinned pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
+ * @param checker_zone: Bitboard of the squares resolving a check, FILLED if not
+ * in check.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
 void generateRookMoves(uint64_t R, uint64_t K, uint64_t PIECES,
                        uint64_t OCCUPIED, uint64_t PINNED,
                        uint64_t checker_zone, Move *moves, uint8_t &n_moves) {
-  if (!checker_zone) {
-    checker_zone = FILLED;
-  }
-
   while (R) {
-
     uint64_t bb = getLowestSetBitValue(R);
     uint8_t bit = getSetBit(bb);
 
-    uint64_t mask = bb & PINNED ? getColinearMask(bb, K) : FILLED;
+    uint64_t mask = bb & PINNED ? line_mask[bit][getSetBit(K)] : FILLED;
 
     uint64_t possible_moves = horizontalAndVerticalMoves(bb, OCCUPIED) &
                               ~PIECES & mask & checker_zone;
-    while (possible_moves) {
-      uint64_t final_bb = getLowestSetBitValue(possible_moves);
-      uint8_t final_bit = getSetBit(final_bb);
-      moves[n_moves++] =
-          Move(bitToX(bit), bitToY(bit), bitToX(final_bit), bitToY(final_bit));
-      clearLowestSetBit(possible_moves);
-    }
+    addMoves(bit, possible_moves, OCCUPIED, moves, n_moves);
     clearLowestSetBit(R);
   }
 }
@@ -456,32 +456,21 @@ void generateRookMoves(uint64_t R, uint64_t K, uint64_t PIECES,
  * @param PIECES: Bitboard of the active player's pieces.
  * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
  * @param PINNED: Bitboard of pinned pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
+ * @param checker_zone: Bitboard of the squares resolving a check, FILLED if not
+ * in check.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
 void generateBishopMoves(uint64_t B, uint64_t K, uint64_t PIECES,
                          uint64_t OCCUPIED, uint64_t PINNED,
                          uint64_t checker_zone, Move *moves, uint8_t &n_moves) {
-  if (!checker_zone) {
-    checker_zone = FILLED;
-  }
-
   while (B) {
     uint64_t bb = getLowestSetBitValue(B);
     uint8_t bit = getSetBit(bb);
-    uint64_t mask = bb & PINNED ? getColinearMask(bb, K) : FILLED;
+    uint64_t mask = bb & PINNED ? line_mask[bit][getSetBit(K)] : FILLED;
     uint64_t possible_moves =
         diagonalMoves(bb, OCCUPIED) & ~PIECES & mask & checker_zone;
-
-    while (possible_moves) {
-      uint64_t bb_final = getLowestSetBitValue(possible_moves);
-      uint8_t final_bit = getSetBit(bb_final);
-      moves[n_moves++] =
-          Move(bitToX(bit), bitToY(bit), bitToX(final_bit), bitToY(final_bit));
-
-      clearLowestSetBit(possible_moves);
-    }
+    addMoves(bit, possible_moves, OCCUPIED, moves, n_moves);
     clearLowestSetBit(B);
   }
 }
@@ -493,33 +482,22 @@ void generateBishopMoves(uint64_t B, uint64_t K, uint64_t PIECES,
  * @param PIECES: Bitboard of the active player's pieces.
  * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
  * @param PINNED: Bitboard of pinned pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
+ * @param checker_zone: Bitboard of the squares resolving a check, FILLED if not
+ * in check.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
 void generateQueenMoves(uint64_t Q, uint64_t K, uint64_t PIECES,
                         uint64_t OCCUPIED, uint64_t PINNED,
                         uint64_t checker_zone, Move *moves, uint8_t &n_moves) {
-  if (!checker_zone) {
-    checker_zone = FILLED;
-  }
-
   while (Q) {
     uint64_t bb = getLowestSetBitValue(Q);
     uint8_t bit = getSetBit(bb);
-    uint64_t mask = bb & PINNED ? getColinearMask(bb, K) : FILLED;
+    uint64_t mask = bb & PINNED ? line_mask[bit][getSetBit(K)] : FILLED;
     uint64_t possible_moves = (horizontalAndVerticalMoves(bb, OCCUPIED) |
                                diagonalMoves(bb, OCCUPIED)) &
                               ~PIECES & mask & checker_zone;
-
-    while (possible_moves) {
-      uint64_t bb_final = getLowestSetBitValue(possible_moves);
-      uint8_t final_bit = getSetBit(bb_final);
-      moves[n_moves++] =
-          Move(bitToX(bit), bitToY(bit), bitToX(final_bit), bitToY(final_bit));
-
-      clearLowestSetBit(possible_moves);
-    }
+    addMoves(bit, possible_moves, OCCUPIED, moves, n_moves);
     clearLowestSetBit(Q);
   }
 }
@@ -528,17 +506,16 @@ void generateQueenMoves(uint64_t Q, uint64_t K, uint64_t PIECES,
  *
  * @param N: Bitboard of the active player's knights.
  * @param PIECES: Bitboard of the active player's pieces.
+ * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
  * @param PINNED: Bitboard of pinned pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
+ * @param checker_zone: Bitboard of the squares resolving a check, FILLED if not
+ * in check.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
-void generateKnightMoves(uint64_t N, uint64_t PIECES, uint64_t PINNED,
-                         uint64_t checker_zone, Move *moves, uint8_t &n_moves) {
-  if (!checker_zone) {
-    checker_zone = FILLED;
-  }
-
+void generateKnightMoves(uint64_t N, uint64_t PIECES, uint64_t OCCUPIED,
+                         uint64_t PINNED, uint64_t checker_zone, Move *moves,
+                         uint8_t &n_moves) {
   while (N) {
     uint64_t bb = getLowestSetBitValue(N);
     uint8_t kn_bit = getSetBit(bb);
@@ -546,14 +523,7 @@ void generateKnightMoves(uint64_t N, uint64_t PIECES, uint64_t PINNED,
     if (!(bb & PINNED)) { // only check for moves if it's not pinned.
                           // pinned knights cannot move.
       uint64_t pos_moves = knight_moves[kn_bit] & ~PIECES & checker_zone;
-      while (pos_moves) {
-        uint64_t bb_final = getLowestSetBitValue(pos_moves);
-        uint8_t final_bit = getSetBit(bb_final);
-        moves[n_moves++] = Move(bitToX(kn_bit), bitToY(kn_bit),
-                                bitToX(final_bit), bitToY(final_bit));
-
-        clearLowestSetBit(pos_moves);
-      }
+      addMoves(kn_bit, pos_moves, OCCUPIED, moves, n_moves);
     }
     clearLowestSetBit(N);
   }
@@ -563,32 +533,52 @@ void generateKnightMoves(uint64_t N, uint64_t PIECES, uint64_t PINNED,
  *
  * @param K: Bitboard of the active player's king.
  * @param PIECES: Bitboard of the active player's pieces.
+ * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
  * @param DZ: Bitboard of the danger zone, where the king cannot pass through.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
-void generateKingMoves(uint64_t K, uint64_t PIECES, uint64_t DZ, Move *moves,
-                       uint8_t &n_moves) {
+void generateKingMoves(uint64_t K, uint64_t PIECES, uint64_t OCCUPIED,
+                       uint64_t DZ, Move *moves, uint8_t &n_moves) {
   uint8_t k_bit = getSetBit(K);
   uint64_t pos_moves = king_moves[k_bit] & ~PIECES & ~DZ;
-  while (pos_moves) {
-    uint64_t bb_final = getLowestSetBitValue(pos_moves);
-    uint8_t final_bit = getSetBit(bb_final);
-    moves[n_moves++] = Move(bitToX(k_bit), bitToY(k_bit), bitToX(final_bit),
-                            bitToY(final_bit));
-    clearLowestSetBit(pos_moves);
-  }
+  addMoves(k_bit, pos_moves, OCCUPIED, moves, n_moves);
+}
+
+/** Shifts pawns one rank forward, from the perspective of their color.
+ *
+ * @param P: Bitboard of the pawns.
+ * @return Shifted bitboard.
+ */
+template <Color Us> constexpr uint64_t shiftForward(uint64_t P) {
+  return Us == WHITE ? P << 8 : P >> 8;
+}
+
+/** Gets the bitboard of the squares the pawns are attacking towards file a.
+ *
+ * @param P: Bitboard of the pawns.
+ * @return Bitboard of the attacked squares.
+ */
+template <Color Us> constexpr uint64_t getPawnAttacksLeft(uint64_t P) {
+  return (Us == WHITE ? P << 7 : P >> 9) & ~file_h;
+}
+
+/** Gets the bitboard of the squares the pawns are attacking towards file h.
+ *
+ * @param P: Bitboard of the pawns.
+ * @return Bitboard of the attacked squares.
+ */
+template <Color Us> constexpr uint64_t getPawnAttacksRight(uint64_t P) {
+  return (Us == WHITE ? P << 9 : P >> 7) & ~file_a;
 }
 
 /** Gets the bitboard of the squares the pawns are attacking.
  *
- * @param white_to_move: Flag denoting the turn.
  * @param P: Bitboard of the pawns.
  * @return Bitboard of the squares the pawns are attacking.
  */
-uint64_t getPawnAttackZone(bool white_to_move, uint64_t P) {
-  return white_to_move ? ((P >> 7) & ~file_a) | ((P >> 9) & ~file_h)
-                       : ((P << 9) & ~file_a) | ((P << 7) & ~file_h);
+template <Color Us> constexpr uint64_t getPawnAttackZone(uint64_t P) {
+  return getPawnAttacksLeft<Us>(P) | getPawnAttacksRight<Us>(P);
 }
 
 /** Gets the bitboard of the squares the rooks/queens are attacking
@@ -655,297 +645,218 @@ uint64_t getKnightAttackZone(uint64_t N) {
  */
 uint64_t getKingAttackZone(uint64_t K) { return king_moves[getSetBit(K)]; }
 
-/** Determines if the bishops/queens are putting the king in check
- * horizontally/vertically.
+/** Returns a bitboard of pieces that are pinned.
  *
  * @param K: Bitboard of the active player's king.
- * @param ER: Bitboard of the enemy player's rooks.
+ * @param P: Bitboard of the active player's pawns.
  * @param EQ: Bitboard of the enemy player's queens.
- * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
- * @param checker_zone: Bitboard of zone of the checkers, if applicable.
- * @return Number of rooks/queens putting the king in check (1 or 2), else 0.
- */
-uint8_t getHorizontalAndVerticalChecker(uint64_t K, uint64_t ER, uint64_t EQ,
-                                        uint64_t OCCUPIED,
-                                        uint64_t &checker_zone) {
-  uint64_t EHV = ER | EQ;
-  uint64_t K_exposure = horizontalAndVerticalMoves(K, OCCUPIED);
-  uint64_t new_checker = K_exposure & EHV;
-  if (countSetBits(new_checker) == 2) {
-    return 2;
-  }
-  if (new_checker) {
-    checker_zone |= new_checker;
-    checker_zone |=
-        horizontalAndVerticalMoves(new_checker, OCCUPIED) & K_exposure;
-    return 1;
-  }
-  return 0;
-}
-
-/** Determines if the bishops/queens are putting the king in check diagonally.
- *
- * @param K: Bitboard of the active player's king.
  * @param EB: Bitboard of the enemy player's bishops.
- * @param EQ: Bitboard of the enemy player's queens.
- * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
- * @param checker_zone: Bitboard of zone of the checkers, if applicable.
- * @return 1 if the bishop/queen is putting the king in check, else 0.
- */
-uint8_t getDiagonalChecker(uint64_t K, uint64_t EB, uint64_t EQ,
-                           uint64_t OCCUPIED, uint64_t &checker_zone) {
-  uint64_t ED = EB | EQ;
-  uint64_t K_exposure = diagonalMoves(K, OCCUPIED);
-  uint64_t new_checker = K_exposure & ED;
-  if (new_checker) {
-    checker_zone |= new_checker;
-    checker_zone |= diagonalMoves(new_checker, OCCUPIED) & K_exposure;
-    return 1;
-  }
-  return 0;
-}
-
-/** Determines if the knights are putting the king in check.
- *
- * @param K: Bitboard of the active player's king.
- * @param EN: Bitboard of the enemy player's knights.
+ * @param ER: Bitboard of the enemy player's rooks.
+ * @param PIECES: Bitboard of the active player's pieces.
  * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
- * @param checker_zone: Bitboard of zone of the checkers, if applicable.
- * @return 1 if the knight is putting the king in check, else 0.
- */
-uint8_t getKnightChecker(uint64_t K, uint64_t EN, uint64_t OCCUPIED,
-                         uint64_t &checker_zone) {
-  // Check for knight attacks.
-  uint64_t K_exposure = knight_moves[getSetBit(K)];
-
-  uint64_t new_checker = K_exposure & EN;
-  if (new_checker) {
-    checker_zone |= new_checker;
-    return 1;
-  }
-  return 0;
-}
-
-/** Determines if the pawns are putting the king in check.
- *
- * @param white_to_move: Flag denoting the turn.
- * @param K: Bitboard of the active player's king.
- * @param EP: Bitboard of the enemy player's pawns.
- * @param checker_zone: Bitboard of zone of the checkers, if applicable.
- * @return 1 if the pawn is putting the king in check, else 0.
+ * @param en_passant: The en passant bit, if applicable.
+ * @return Bitboard of the active player's pinned pieces.
  */
-uint8_t getPawnChecker(bool white_to_move, uint64_t K, uint64_t EP,
-                       uint64_t &checker_zone) {
-
-  if (white_to_move) {
-    // Check for pawn right attack (from pawns perspective).
-    uint64_t K_exposure = (K << 7) & ~file_h;
-    uint64_t new_checker = K_exposure & EP;
-    if (new_checker) {
-      checker_zone |= new_checker;
-      return 1;
-    }
+template <Color Us>
+uint64_t getPinnedPieces(uint64_t K, uint64_t P, uint64_t EQ, uint64_t EB,
+                         uint64_t ER, uint64_t PIECES, uint64_t OCCUPIED,
+                         int8_t &en_passant) {
+  uint64_t PINNED = 0;
+  uint8_t k_bit = getSetBit(K);
 
-    // check for pawn left attack (from pawns perspective)
-    K_exposure = (K << 9) & ~file_a;
-    new_checker = K_exposure & EP;
-    if (new_checker) {
-      checker_zone |= new_checker;
-      return 1;
-    }
+  // Enemy sliders on a line with the king, ignoring the pieces in between.
+  uint64_t EHV = horizontalAndVerticalMoves(K, 0) & (EQ | ER);
+  uint64_t snipers = EHV | (diagonalMoves(K, 0) & (EQ | EB));
 
-  } else {
-    // Check for pawn right attack (from pawns perspective).
-    uint64_t K_exposure = (K >> 9) & ~file_h;
-    uint64_t new_checker = K_exposure & EP;
-    if (new_checker) {
-      checker_zone |= new_checker;
-      return 1;
+  // Pawns that could capture en passant: the en passant square is attacked by
+  // them, from the enemy's point of view.
+  uint64_t E_P = getEnPassantBitboard(en_passant);
+  uint64_t ep_pawn = Us == WHITE ? E_P >> 8 : E_P << 8;
+  uint64_t P_EP = P & getPawnAttackZone<Us == WHITE ? BLACK : WHITE>(E_P);
+
+  while (snipers) {
+    uint8_t bit = getSetBit(getLowestSetBitValue(snipers));
+    uint64_t blockers = between_mask[k_bit][bit] & OCCUPIED;
+    // A lone enemy piece in between is not pinned to our king.
+    if (countSetBits(blockers) == 1) {
+      PINNED |= blockers & PIECES;
     }
 
-    // check for pawn left attack (from pawns perspective)
-    K_exposure = (K >> 7) & ~file_a;
-    new_checker = K_exposure & EP;
-    if (new_checker) {
-      checker_zone |= new_checker;
-      return 1;
+    // Special en passant pin: the capture removes both pawns from the rank
+    // between the king and a horizontal slider.
+    if (P_EP && (EHV & directional_mask[k_bit][RANKS] & (1ULL << bit)) &&
+        countSetBits(blockers) == 2 && (blockers & ep_pawn) &&
+        (blockers & P_EP)) {
+      en_passant = -1;
     }
+    clearLowestSetBit(snipers);
   }
-
-  return 0;
+  return PINNED;
 }
 
-/** Determines if the king is in check.
+/** Gets the bitboards of the squares attacked by each of the player's piece
+ * types.
  *
- * @param white_to_move: Flag denoting the turn.
- * @param K: Bitboard of the active player's king.
- * @param enemy_player_state: Enemy player state.
+ * @param pieces: Bitboard of each of the player's piece types.
  * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
- * @param DZ: Bitboard of the danger zone, where the king cannot pass through.
- * @param checker_zone: Bitboard of zone of the checkers, if applicable.
- * @param n_checkers: The number of pieces putting the king in check.
- * @return true if in check, else false.
+ * @param attacks: Attack bitboard per piece type, populated by this function.
+ * @return Bitboard of all the squares the player is attacking.
  */
-bool isInCheck(bool white_to_move, uint64_t K, ColorState enemy_player_state,
-               uint64_t OCCUPIED, uint64_t &DZ, uint64_t &checker_zone,
-               uint8_t &n_checkers) {
-  DZ |= getPawnAttackZone(white_to_move, enemy_player_state.pawn);
-  DZ |= getRookQueenAttackZone(K, enemy_player_state.rook,
-                               enemy_player_state.queen, OCCUPIED);
-  DZ |= getBishopQueenAttackZone(K, enemy_player_state.bishop,
-                                 enemy_player_state.queen, OCCUPIED);
-  DZ |= getKnightAttackZone(enemy_player_state.knight);
-  DZ |= getKingAttackZone(enemy_player_state.king);
-
-  bool check = K & DZ;
-  if (check) {
-    n_checkers +=
-        getPawnChecker(white_to_move, K, enemy_player_state.pawn, checker_zone);
-    n_checkers += getHorizontalAndVerticalChecker(K, enemy_player_state.rook,
-                                                  enemy_player_state.queen,
-                                                  OCCUPIED, checker_zone);
-    n_checkers +=
-        getDiagonalChecker(K, enemy_player_state.bishop,
-                           enemy_player_state.queen, OCCUPIED, checker_zone);
-    n_checkers +=
-        getKnightChecker(K, enemy_player_state.knight, OCCUPIED, checker_zone);
-  }
-  return check;
+template <Color Us>
+uint64_t getPlayerAttackZones(const uint64_t pieces[N_PIECE_TYPES],
+                              uint64_t OCCUPIED,
+                              uint64_t attacks[N_PIECE_TYPES]) {
+  attacks[PAWN] = getPawnAttackZone<Us>(pieces[PAWN]);
+  attacks[KNIGHT] = getKnightAttackZone(pieces[KNIGHT]);
+  attacks[BISHOP] =
+      getBishopQueenAttackZone(0, pieces[BISHOP], 0, OCCUPIED);
+  attacks[ROOK] = getRookQueenAttackZone(0, pieces[ROOK], 0, OCCUPIED);
+  attacks[QUEEN] =
+      getRookQueenAttackZone(0, 0, pieces[QUEEN], OCCUPIED) |
+      getBishopQueenAttackZone(0, 0, pieces[QUEEN], OCCUPIED);
+  attacks[KING] = getKingAttackZone(pieces[KING]);
+  return attacks[PAWN] | attacks[KNIGHT] | attacks[BISHOP] | attacks[ROOK] |
+         attacks[QUEEN] | attacks[KING];
 }
 
-/** Returns a bitboard of pieces that are pinned.
+/** Updates the cached checkers and pinned pieces of the position, for the
+ * active player Us. Also clears the en passant bit if the en passant capture
+ * would expose the king to a horizontal check.
  *
- * @param K: Bitboard of the active player's king.
- * @param P: Bitboard of the active player's pawns.
- * @param EQ: Bitboard of the enemy player's queens.
- * @param EB: Bitboard of the enemy player's bishops.
- * @param ER: Bitboard of the enemy player's rooks.
- * @param OCCUPIED: Bitboard of all the occupied spaces on the board.
- * @param en_passant: The en passant bit, if applicable.
- * @param white_to_move: Flag denoting the turn.
- * @return Bitboard of all pinned pieces.
+ * @param game_state: Game state.
  */
-uint64_t getPinnedPieces(uint64_t K, uint64_t P, uint64_t EQ, uint64_t EB,
-                         uint64_t ER, uint64_t OCCUPIED, int8_t &en_passant,
-                         bool white_to_move) {
-  uint64_t PINNED = 0;
-  uint8_t k_bit = getSetBit(K);
+template <Color Us> void updateCheckState(GameState &game_state) {
+  const uint64_t *player = game_state.pieces[Us];
+  const uint64_t *enemy = game_state.pieces[Us ^ 1];
+  uint64_t OCCUPIED = game_state.occupied;
+  uint64_t K = player[KING];
+
+  game_state.checkers =
+      (horizontalAndVerticalMoves(K, OCCUPIED) & (enemy[ROOK] | enemy[QUEEN])) |
+      (diagonalMoves(K, OCCUPIED) & (enemy[BISHOP] | enemy[QUEEN])) |
+      (knight_moves[getSetBit(K)] & enemy[KNIGHT]) |
+      (getPawnAttackZone<Us>(K) & enemy[PAWN]);
+  game_state.pinned =
+      getPinnedPieces<Us>(K, player[PAWN], enemy[QUEEN], enemy[BISHOP],
+                          enemy[ROOK], game_state.occupancy[Us], OCCUPIED,
+                          game_state.en_passant);
+}
 
-  // Horizontal check.
-  uint64_t K_h_v_slider = horizontalAndVerticalMoves(K, OCCUPIED);
-  uint64_t K_slider = K_h_v_slider & directional_mask[k_bit][RANKS];
+void updateCheckState(GameState &game_state) {
+  game_state.side_to_move == WHITE ? updateCheckState<WHITE>(game_state)
+                                   : updateCheckState<BLACK>(game_state);
+}
 
-  uint64_t EHV = EQ | ER;
-  while (EHV) {
-    uint64_t bb = getLowestSetBitValue(EHV);
-    uint64_t H_moves = horizontalAndVerticalMoves(bb, OCCUPIED) &
-                       directional_mask[getSetBit(bb)][RANKS];
-
-    uint64_t E_P = getEnPassantBitboard(en_passant);
-    // Check for special en passant pins.
-    uint64_t ep_pawn = white_to_move ? E_P >> 8 : E_P << 8;
-    uint64_t p_can_capture_ep_r =
-        P & (white_to_move ? (E_P >> 9) & ~file_h : (E_P << 7) & ~file_a);
-    uint64_t p_can_capture_ep_l =
-        P & (white_to_move ? (E_P >> 7) & ~file_a : (E_P << 9) & ~file_h);
-    bool none_between_king_and_ep_p = ep_pawn & K_slider;
-    bool none_between_ep_p_and_attacker = ep_pawn & H_moves;
-
-    if ((none_between_king_and_ep_p && (p_can_capture_ep_r & H_moves)) ||
-        (none_between_ep_p_and_attacker && (p_can_capture_ep_r & K_slider)) ||
-        (none_between_king_and_ep_p && (p_can_capture_ep_l & H_moves)) ||
-        (none_between_ep_p_and_attacker && (p_can_capture_ep_l & K_slider))) {
-      en_passant = -1;
+/** Computes the attack information of the position, for the active player Us.
+ *
+ * @param game_state: Game state.
+ * @param attack_info: Attack information to populate.
+ * @param active_player_attacks: If false, the active player's attacks are
+ * skipped.
+ */
+template <Color Us>
+void computeAttackInfo(const GameState &game_state, AttackInfo &attack_info,
+                       bool active_player_attacks) {
+  constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+  const uint64_t *player = game_state.pieces[Us];
+  const uint64_t *enemy = game_state.pieces[Us ^ 1];
+  uint64_t OCCUPIED = game_state.occupied;
+  uint64_t K = player[KING];
+
+  attack_info.all_attacks[Them] =
+      getPlayerAttackZones<Them>(enemy, OCCUPIED, attack_info.attacks[Them]);
+  attack_info.all_attacks[Us] =
+      active_player_attacks
+          ? getPlayerAttackZones<Us>(player, OCCUPIED, attack_info.attacks[Us])
+          : 0;
+  attack_info.danger_zone = attack_info.all_attacks[Them];
+  attack_info.checkers = game_state.checkers;
+  attack_info.checker_zone = 0;
+  attack_info.n_checkers = countSetBits(game_state.checkers);
+  attack_info.pinned = game_state.pinned;
+
+  if (attack_info.n_checkers) {
+    // Sliders putting the king in check also attack the squares behind it.
+    uint64_t h_v_checkers = game_state.checkers & (enemy[ROOK] | enemy[QUEEN]) &
+                            horizontalAndVerticalMoves(K, 0);
+    uint64_t diag_checkers = game_state.checkers &
+                             (enemy[BISHOP] | enemy[QUEEN]) &
+                             diagonalMoves(K, 0);
+    attack_info.danger_zone |=
+        getRookQueenAttackZone(K, h_v_checkers, 0, OCCUPIED) |
+        getBishopQueenAttackZone(K, diag_checkers, 0, OCCUPIED);
+
+    // A single check can also be resolved by blocking the line of attack.
+    if (attack_info.n_checkers == 1) {
+      attack_info.checker_zone =
+          attack_info.checkers |
+          between_mask[getSetBit(K)][getSetBit(attack_info.checkers)];
     }
-    PINNED |= K_slider & H_moves;
-    clearLowestSetBit(EHV);
-  }
-
-  // Vertical check.
-  EHV = EQ | ER;
-  K_slider = K_h_v_slider & directional_mask[k_bit][FILES];
-
-  while (EHV) {
-    uint64_t bb = getLowestSetBitValue(EHV);
-    PINNED |= K_slider & horizontalAndVerticalMoves(bb, OCCUPIED) &
-              directional_mask[getSetBit(bb)][FILES];
-    clearLowestSetBit(EHV);
-  }
-
-  // Down right diagonal check.
-  uint64_t K_slider_diag = diagonalMoves(K, OCCUPIED);
-  uint64_t ED = EQ | EB;
-  K_slider = K_slider_diag & directional_mask[k_bit][DIAGONALS_DOWN_RIGHT];
-  while (ED) {
-    uint64_t bb = getLowestSetBitValue(ED);
-    PINNED |= K_slider & diagonalMoves(bb, OCCUPIED) &
-              directional_mask[getSetBit(bb)][DIAGONALS_DOWN_RIGHT];
-
-    clearLowestSetBit(ED);
   }
+}
 
-  // Upper right diagonal check.
-  ED = EQ | EB;
-  K_slider = K_slider_diag & directional_mask[k_bit][DIAGONALS_UP_RIGHT];
-  while (ED) {
-    uint64_t bb = getLowestSetBitValue(ED);
-    PINNED |= K_slider & diagonalMoves(bb, OCCUPIED) &
-              directional_mask[getSetBit(bb)][DIAGONALS_UP_RIGHT];
-    clearLowestSetBit(ED);
-  }
-  return PINNED;
+void computeAttackInfo(const GameState &game_state, AttackInfo &attack_info,
+                       bool active_player_attacks) {
+  game_state.side_to_move == WHITE
+      ? computeAttackInfo<WHITE>(game_state, attack_info, active_player_attacks)
+      : computeAttackInfo<BLACK>(game_state, attack_info,
+                                 active_player_attacks);
 }
 
-/** Adds the kingside castle move to the move list, if applicable.
+// First square of the player's back rank.
+template <Color Us> constexpr uint8_t BACK_RANK_SHIFT = Us == WHITE ? 0 : 56;
+// Squares f and g, which must be empty and not attacked to castle kingside.
+template <Color Us>
+constexpr uint64_t KINGSIDE_CASTLE_PATH = 0x60ULL << BACK_RANK_SHIFT<Us>;
+// Squares b, c and d, which must be empty to castle queenside.
+template <Color Us>
+constexpr uint64_t QUEENSIDE_CASTLE_EMPTY = 0xEULL << BACK_RANK_SHIFT<Us>;
+// Squares c and d, which must not be attacked to castle queenside.
+template <Color Us>
+constexpr uint64_t QUEENSIDE_CASTLE_PATH = 0xCULL << BACK_RANK_SHIFT<Us>;
+
+/** Adds the castle moves to the move list, if applicable. The king and the
+ * squares it passes through must not be attacked, and the squares between the
+ * king and the rook must be empty.
  *
- * @param CK: Flag denoting if the kingside castle is still available.
- * @param K: Bitboard of the active player's king.
+ * @param game_state: Game state.
  * @param EMPTY: Bitboard of the empty squares.
  * @param DZ: Bitboard of the danger zone, where the king is not allowed to pass
  * through.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
-void generateKingsideCastleMove(bool CK, uint64_t K, uint64_t EMPTY,
-                                uint64_t DZ, Move *moves, uint8_t &n_moves) {
-  if (!CK) {
-    return;
+template <Color Us>
+void generateCastleMoves(const GameState &game_state, uint64_t EMPTY,
+                         uint64_t DZ, Move *moves, uint8_t &n_moves) {
+  constexpr uint8_t SHIFT = BACK_RANK_SHIFT<Us>;
+  if (game_state.canKingSideCastle(Us) &&
+      !(KINGSIDE_CASTLE_PATH<Us> & (~EMPTY | DZ))) {
+    moves[n_moves++] = Move(SHIFT + 4, SHIFT + 6, CASTLE_KINGSIDE);
   }
-
-  if ((K << 2) & EMPTY & (EMPTY << 1) & ~DZ & ~(DZ << 1)) {
-    uint8_t k_bit =
-        getSetBit((K << 2) & EMPTY & (EMPTY << 1) & ~DZ & ~(DZ << 1));
-
-    uint8_t x = bitToX(k_bit);
-    uint8_t y = bitToY(k_bit);
-    moves[n_moves++] = Move(x, y - 2, x, y, CASTLE_KINGSIDE);
+  if (game_state.canQueenSideCastle(Us) &&
+      !(QUEENSIDE_CASTLE_EMPTY<Us> & ~EMPTY) &&
+      !(QUEENSIDE_CASTLE_PATH<Us> & DZ)) {
+    moves[n_moves++] = Move(SHIFT + 4, SHIFT + 2, CASTLE_QUEENSIDE);
   }
 }
 
-/** Adds the queenside castle move to the move list, if applicable.
+/** Counts the castle moves, under the same conditions as generateCastleMoves.
  *
- * @param QK: Flag denoting if the queenside castle is still available.
- * @param K: Bitboard of the active player's king.
+ * @param game_state: Game state.
  * @param EMPTY: Bitboard of the empty squares.
  * @param DZ: Bitboard of the danger zone, where the king is not allowed to pass
  * through.
- * @param moves: Move list.
- * @param n_moves: Running total number of moves.
+ * @return Number of castle moves, 0 to 2.
  */
-void generateQueensideCastleMove(bool QK, uint64_t K, uint64_t EMPTY,
-                                 uint64_t DZ, Move *moves, uint8_t &n_moves) {
-  if (!QK) {
-    return;
-  }
-
-  if ((((K >> 2) & EMPTY) & (EMPTY >> 1) & (EMPTY << 1) & ~DZ & ~(DZ >> 1)) !=
-      0u) {
-    uint8_t k_bit = getSetBit(((K >> 2) & EMPTY) & (EMPTY >> 1) & (EMPTY << 1) &
-                              ~DZ & ~(DZ >> 1));
-    uint8_t x = bitToX(k_bit);
-    uint8_t y = bitToY(k_bit);
-    moves[n_moves++] = Move(x, y + 2, x, y, CASTLE_QUEENSIDE);
-  }
+template <Color Us>
+uint8_t countCastleMoves(const GameState &game_state, uint64_t EMPTY,
+                         uint64_t DZ) {
+  return (game_state.canKingSideCastle(Us) &&
+          !(KINGSIDE_CASTLE_PATH<Us> & (~EMPTY | DZ))) +
+         (game_state.canQueenSideCastle(Us) &&
+          !(QUEENSIDE_CASTLE_EMPTY<Us> & ~EMPTY) &&
+          !(QUEENSIDE_CASTLE_PATH<Us> & DZ));
 }
 
 /** Helper function that adds all 4 promotion moves to the move list.
@@ -965,347 +876,562 @@ void addAllPromotionMoves(Move move, Move *moves, uint8_t &n_moves){
   moves[n_moves++] = move;
 }
 
-/** Generates the possible/legal moves for pinned pawns.
+/** Adds the moves ending on the target squares to the move list. The origin of
+ * each move is the target square shifted back by a fixed offset.
+ *
+ * BACK is the offset from the target square back to the origin square. If
+ * PROMOTION is set, all 4 promotion moves are added per target.
+ *
+ * @param targets: Bitboard of the target squares.
+ * @param moves: Move list.
+ * @param n_moves: Running total number of moves.
+ */
+template <int8_t BACK, bool CAPTURE, bool PROMOTION,
+          MoveType MOVE_TYPE = NONE>
+void addPawnMoves(uint64_t targets, Move *moves, uint8_t &n_moves) {
+  while (targets) {
+    uint8_t final_bit = getSetBit(getLowestSetBitValue(targets));
+    Move move = Move(final_bit + BACK, final_bit, MOVE_TYPE, CAPTURE);
+    if constexpr (PROMOTION) {
+      addAllPromotionMoves(move, moves, n_moves);
+    } else {
+      moves[n_moves++] = move;
+    }
+    clearLowestSetBit(targets);
+  }
+}
+
+/** Generates the possible/legal pawn moves.
  *
- * @param white_to_move: Flag denoting the turn.
  * @param PINNED_MASK: The line of pinning, if applicable.
  * @param P: Bitboard of active player's pawns.
- * @param K: Bitboard of active player's king.
  * @param en_passant: The en passant bit, if applicable.
  * @param EMPTY: Bitboard of empty squares.
  * @param ENEMY_PIECES: Bitboard of enemy pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
+ * @param checker_zone: Bitboard of the squares resolving a check, FILLED if not
+ * in check.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
-void generatePawnMoves(bool white_to_move, uint64_t PINNED_MASK, uint64_t P,
-                       uint64_t K, int8_t en_passant, uint64_t EMPTY,
-                       uint64_t ENEMY_PIECES, uint64_t checker_zone,
-                       Move *moves, uint8_t &n_moves) {
-  uint64_t P_FORWARD_1 =
-      EMPTY & PINNED_MASK & checker_zone &
-      (white_to_move ? (P << 8) & ~rank_8 : (P >> 8) & ~rank_1);
-  uint64_t P_FORWARD_2 = EMPTY & PINNED_MASK & checker_zone &
-                         (white_to_move ? (P << 16) & (EMPTY << 8) & rank_4
-                                        : (P >> 16) & (EMPTY >> 8) & rank_5);
-  uint64_t P_ATTACK_L =
-      ENEMY_PIECES & ~file_h & PINNED_MASK & checker_zone &
-      (white_to_move ? (P << 7) & ~rank_8 : (P >> 9) & ~rank_1);
-  uint64_t P_ATTACK_R =
-      ENEMY_PIECES & ~file_a & PINNED_MASK & checker_zone &
-      (white_to_move ? (P << 9) & ~rank_8 : (P >> 7) & ~rank_1);
-  uint64_t P_PROMO_1 = EMPTY & PINNED_MASK & checker_zone &
-                       (white_to_move ? (P << 8) & rank_8 : (P >> 8) & rank_1);
-  uint64_t P_PROMO_L = ENEMY_PIECES & ~file_h & PINNED_MASK & checker_zone &
-                       (white_to_move ? (P << 7) & rank_8 : (P >> 9) & rank_1);
-  uint64_t P_PROMO_R = ENEMY_PIECES & ~file_a & PINNED_MASK & checker_zone &
-                       (white_to_move ? (P << 9) & rank_8 : (P >> 7) & rank_1);
-
+template <Color Us>
+void generatePawnMoves(uint64_t PINNED_MASK, uint64_t P, int8_t en_passant,
+                       uint64_t EMPTY, uint64_t ENEMY_PIECES,
+                       uint64_t checker_zone, Move *moves, uint8_t &n_moves) {
+  // Offsets from the target square back to the origin square.
+  constexpr int8_t BACK = Us == WHITE ? -8 : 8;
+  constexpr int8_t BACK_L = BACK + 1;
+  constexpr int8_t BACK_R = BACK - 1;
+  constexpr uint64_t PROMOTION_RANK = Us == WHITE ? rank_8 : rank_1;
+  constexpr uint64_t PUSH_2_RANK = Us == WHITE ? rank_4 : rank_5;
+
+  uint64_t TARGETS = PINNED_MASK & checker_zone;
+  uint64_t P_FORWARD = shiftForward<Us>(P) & EMPTY & TARGETS;
+  uint64_t P_FORWARD_2 = shiftForward<Us>(shiftForward<Us>(P) & EMPTY) &
+                         EMPTY & PUSH_2_RANK & TARGETS;
+  uint64_t P_ATTACK_L = getPawnAttacksLeft<Us>(P) & ENEMY_PIECES & TARGETS;
+  uint64_t P_ATTACK_R = getPawnAttacksRight<Us>(P) & ENEMY_PIECES & TARGETS;
+
+  addPawnMoves<BACK, false, false>(P_FORWARD & ~PROMOTION_RANK, moves,
+                                   n_moves);
+  addPawnMoves<2 * BACK, false, false, PAWN_PUSH_2>(P_FORWARD_2, moves,
+                                                     n_moves);
+  addPawnMoves<BACK_L, true, false>(P_ATTACK_L & ~PROMOTION_RANK, moves,
+                                    n_moves);
+  addPawnMoves<BACK_R, true, false>(P_ATTACK_R & ~PROMOTION_RANK, moves,
+                                    n_moves);
+  addPawnMoves<BACK, false, true>(P_FORWARD & PROMOTION_RANK, moves, n_moves);
+  addPawnMoves<BACK_L, true, true>(P_ATTACK_L & PROMOTION_RANK, moves,
+                                   n_moves);
+  addPawnMoves<BACK_R, true, true>(P_ATTACK_R & PROMOTION_RANK, moves,
+                                   n_moves);
+
+  // Capturing the pawn that just moved 2 also resolves its check.
   uint64_t E_P = getEnPassantBitboard(en_passant);
-  checker_zone |= white_to_move && ((E_P >> 8) & checker_zone) ? E_P : 0;
-  checker_zone |= !white_to_move && ((E_P << 8) & checker_zone) ? E_P : 0;
-  uint64_t P_EP_L = E_P & ~file_h & PINNED_MASK & checker_zone &
-                    (white_to_move ? P << 7 : P >> 9);
-  uint64_t P_EP_R = E_P & ~file_a & PINNED_MASK & checker_zone &
-                    (white_to_move ? P << 9 : P >> 7);
-
-  // CHECK TO SEE IF WE CAN MOVE 1 SPACE FORWARD
-  while (P_FORWARD_1) {
-    uint64_t bb = getLowestSetBitValue(P_FORWARD_1);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    moves[n_moves++] = Move(x + (white_to_move ? -1 : 1), y, x, y);
-    clearLowestSetBit(P_FORWARD_1);
-  }
-
-  // check to see if you can move 2
-  while (P_FORWARD_2) {
-    uint64_t bb = getLowestSetBitValue(P_FORWARD_2);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    moves[n_moves++] = Move(x + (white_to_move ? -2 : 2), y, x, y, PAWN_PUSH_2);
-    clearLowestSetBit(P_FORWARD_2);
-  }
-
-  // check for attacks left
-  while (P_ATTACK_L) {
-    uint64_t bb = getLowestSetBitValue(P_ATTACK_L);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    moves[n_moves++] = Move(x + (white_to_move ? -1 : 1), y + 1, x, y);
-    clearLowestSetBit(P_ATTACK_L);
-  }
-
-  // check for attacks right
-  while (P_ATTACK_R) {
-    uint64_t bb = getLowestSetBitValue(P_ATTACK_R);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    moves[n_moves++] = Move(x + (white_to_move ? -1 : 1), y - 1, x, y);
-    clearLowestSetBit(P_ATTACK_R);
-  }
-
-  // check for promotion straight
-  while (P_PROMO_1) {
-    uint64_t bb = getLowestSetBitValue(P_PROMO_1);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    addAllPromotionMoves(Move(x + (white_to_move ? -1 : 1), y, x, y), moves,
-                         n_moves);
-    clearLowestSetBit(P_PROMO_1);
-  }
-
-  // check for promotion left
-  while (P_PROMO_L) {
-    uint64_t bb = getLowestSetBitValue(P_PROMO_L);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    addAllPromotionMoves(Move(x + (white_to_move ? -1 : 1), y + 1, x, y), moves,
-                         n_moves);
-    clearLowestSetBit(P_PROMO_L);
-  }
-
-  // check for promotion attack right
-  while (P_PROMO_R) {
-    uint64_t bb = getLowestSetBitValue(P_PROMO_R);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    addAllPromotionMoves(Move(x + (white_to_move ? -1 : 1), y - 1, x, y), moves,
-                         n_moves);
-    clearLowestSetBit(P_PROMO_R);
-  }
-
-  // check for en passant left
-  while (P_EP_L) {
-    uint64_t bb = getLowestSetBitValue(P_EP_L);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    moves[n_moves++] = Move(x + (white_to_move ? -1 : 1), y + 1, x, y);
-    clearLowestSetBit(P_EP_L);
-  }
-
-  // check for en passant right
-  while (P_EP_R) {
-    uint64_t bb = getLowestSetBitValue(P_EP_R);
-    uint8_t final_bit = getSetBit(bb);
-    uint8_t x = bitToX(final_bit);
-    uint8_t y = bitToY(final_bit);
-    moves[n_moves++] = Move(x + (white_to_move ? -1 : 1), y - 1, x, y);
-    clearLowestSetBit(P_EP_R);
+  if (shiftForward<Us == WHITE ? BLACK : WHITE>(E_P) & checker_zone) {
+    checker_zone |= E_P;
   }
+  TARGETS = E_P & PINNED_MASK & checker_zone;
+  addPawnMoves<BACK_L, true, false>(getPawnAttacksLeft<Us>(P) & TARGETS,
+                                    moves, n_moves);
+  addPawnMoves<BACK_R, true, false>(getPawnAttacksRight<Us>(P) & TARGETS,
+                                    moves, n_moves);
 }
 
-/** Generates the possible/legal moves for pinned pawns.
+/** Generates the possible/legal moves for pinned pawns, and removes them from
+ * the pawn bitboard.
  *
- * @param white_to_move: Flag denoting the turn.
  * @param P: Bitboard of active player's pawns.
  * @param K: Bitboard of active player's king.
  * @param en_passant: The en passant bit, if applicable.
  * @param EMPTY: Bitboard of empty squares.
  * @param ENEMY_PIECES: Bitboard of enemy pieces.
  * @param PINNED: Bitboard of pinned pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
+ * @param checker_zone: Bitboard of the squares resolving a check, FILLED if not
+ * in check.
  * @param moves: Move list.
  * @param n_moves: Running total number of moves.
  */
-void generatePinnedPawnMoves(bool white_to_move, uint64_t &P, uint64_t K,
-                             int8_t en_passant, uint64_t EMPTY,
-                             uint64_t ENEMY_PIECES, uint64_t PINNED,
-                             uint64_t checker_zone, Move *moves,
-                             uint8_t &n_moves) {
+template <Color Us>
+void generatePinnedPawnMoves(uint64_t &P, uint64_t K, int8_t en_passant,
+                             uint64_t EMPTY, uint64_t ENEMY_PIECES,
+                             uint64_t PINNED, uint64_t checker_zone,
+                             Move *moves, uint8_t &n_moves) {
   uint64_t pinned_pawns = P & PINNED;
   while (pinned_pawns) {
     uint64_t bb = getLowestSetBitValue(pinned_pawns);
-    uint64_t mask = getColinearMask(bb, K);
-    generatePawnMoves(white_to_move, mask, bb, K, en_passant, EMPTY,
-                      ENEMY_PIECES, checker_zone, moves, n_moves);
+    uint64_t mask = line_mask[getSetBit(bb)][getSetBit(K)];
+    generatePawnMoves<Us>(mask, bb, en_passant, EMPTY, ENEMY_PIECES,
+                          checker_zone, moves, n_moves);
     clearLowestSetBit(pinned_pawns);
   }
   // Clear pinned pawns from pawn bitboard.
   P &= ~PINNED;
 }
 
-/** Generates the possible/legal moves for black pawns.
+/** Generates the possible/legal moves for the active player Us.
  *
- * @param white_to_move: Flag denoting the turn.
- * @param BP: Bitboard of black pawns.
- * @param BK: Bitboard of black king.
- * @param en_passant: The en passant bit, if applicable.
- * @param EMPTY: Bitboard of empty squares.
- * @param WHITE_PIECES: Bitboard of white pieces.
- * @param PINNED: Bitboard of pinned pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
+ * @param game_state: Game state.
+ * @param attack_info: Attack information of the game state.
  * @param moves: Move list.
- * @param n_moves: Running total number of moves.
+ * @return Number of moves.
  */
-void generateBlackPawnMoves(bool white_to_move, uint64_t BP, uint64_t BK,
-                            int8_t en_passant, uint64_t EMPTY,
-                            uint64_t WHITE_PIECES, uint64_t PINNED,
-                            uint64_t checker_zone, Move *moves,
-                            uint8_t &n_moves) {
-  if (!checker_zone) {
-    checker_zone = FILLED;
-  }
+template <Color Us>
+uint8_t generatePlayerMoves(GameState &game_state,
+                            const AttackInfo &attack_info, Move *moves) {
+  const uint64_t *player = game_state.pieces[Us];
+  uint64_t PIECES = game_state.occupancy[Us];
+  uint64_t ENEMY_PIECES = game_state.occupancy[Us ^ 1];
+  uint64_t OCCUPIED = PIECES | ENEMY_PIECES;
+  uint64_t DZ = attack_info.danger_zone;
+  uint64_t PINNED = attack_info.pinned;
+  uint64_t checker_zone =
+      attack_info.n_checkers ? attack_info.checker_zone : FILLED;
 
-  generatePinnedPawnMoves(white_to_move, BP, BK, en_passant, EMPTY,
-                          WHITE_PIECES, PINNED, checker_zone, moves, n_moves);
+  uint8_t n_moves = 0;
+  if (!attack_info.n_checkers) {
+    generateCastleMoves<Us>(game_state, ~OCCUPIED, DZ, moves, n_moves);
+  }
 
-  if (BP) { // we have at least 1 non-pinned pawn.
-    generatePawnMoves(white_to_move, FILLED, BP, BK, en_passant, EMPTY,
-                      WHITE_PIECES, checker_zone, moves, n_moves);
+  if (attack_info.n_checkers < 2) {
+    uint64_t P = player[PAWN];
+    generatePinnedPawnMoves<Us>(P, player[KING], game_state.en_passant,
+                                ~OCCUPIED, ENEMY_PIECES, PINNED, checker_zone,
+                                moves, n_moves);
+    if (P) { // we have at least 1 non-pinned pawn.
+      generatePawnMoves<Us>(FILLED, P, game_state.en_passant, ~OCCUPIED,
+                            ENEMY_PIECES, checker_zone, moves, n_moves);
+    }
+    generateRookMoves(player[ROOK], player[KING], PIECES, OCCUPIED, PINNED,
+                      checker_zone, moves, n_moves);
+    generateBishopMoves(player[BISHOP], player[KING], PIECES, OCCUPIED, PINNED,
+                        checker_zone, moves, n_moves);
+    generateQueenMoves(player[QUEEN], player[KING], PIECES, OCCUPIED, PINNED,
+                       checker_zone, moves, n_moves);
+    generateKnightMoves(player[KNIGHT], PIECES, OCCUPIED, PINNED, checker_zone,
+                        moves, n_moves);
   }
+  generateKingMoves(player[KING], PIECES, OCCUPIED, DZ, moves, n_moves);
+
+  return n_moves;
+}
+
+uint8_t generateMoves(GameState &game_state, const AttackInfo &attack_info,
+                      Move *moves) {
+  return game_state.side_to_move == WHITE
+             ? generatePlayerMoves<WHITE>(game_state, attack_info, moves)
+             : generatePlayerMoves<BLACK>(game_state, attack_info, moves);
 }
 
-/** Generates the possible/legal moves for white pawns.
+uint8_t generateMoves(GameState &game_state, Move *moves, bool &check) {
+  // Only the legality information is needed here, skip the active player's
+  // attacks.
+  AttackInfo attack_info;
+  computeAttackInfo(game_state, attack_info, false);
+  check = attack_info.n_checkers;
+  return generateMoves(game_state, attack_info, moves);
+}
+
+/** Counts the possible/legal pawn moves, as generatePawnMoves() would generate
+ * them.
  *
- * @param white_to_move: Flag denoting the turn.
- * @param WP: Bitboard of white pawns.
- * @param WK: Bitboard of white king.
+ * @param PINNED_MASK: The line of pinning, if applicable.
+ * @param P: Bitboard of active player's pawns.
  * @param en_passant: The en passant bit, if applicable.
  * @param EMPTY: Bitboard of empty squares.
- * @param BLACK_PIECES: Bitboard of black pieces.
- * @param PINNED: Bitboard of pinned pieces.
- * @param checker_zone: Bitboard of the zone of the checkers, if applicable.
- * @param moves: Move list.
- * @param n_moves: Running total number of moves.
+ * @param ENEMY_PIECES: Bitboard of enemy pieces.
+ * @param checker_zone: Bitboard of the squares resolving a check, FILLED if not
+ * in check.
+ * @return Number of moves.
  */
-void generateWhitePawnMoves(bool white_to_move, uint64_t WP, uint64_t WK,
-                            int8_t en_passant, uint64_t EMPTY,
-                            uint64_t BLACK_PIECES, uint64_t PINNED,
-                            uint64_t checker_zone, Move *moves,
-                            uint8_t &n_moves) {
-  if (!checker_zone) {
-    checker_zone = FILLED;
+template <Color Us>
+uint8_t countPawnMoves(uint64_t PINNED_MASK, uint64_t P, int8_t en_passant,
+                       uint64_t EMPTY, uint64_t ENEMY_PIECES,
+                       uint64_t checker_zone) {
+  constexpr uint64_t PROMOTION_RANK = Us == WHITE ? rank_8 : rank_1;
+  constexpr uint64_t PUSH_2_RANK = Us == WHITE ? rank_4 : rank_5;
+
+  uint64_t TARGETS = PINNED_MASK & checker_zone;
+  uint64_t P_FORWARD = shiftForward<Us>(P) & EMPTY & TARGETS;
+  uint64_t P_FORWARD_2 = shiftForward<Us>(shiftForward<Us>(P) & EMPTY) &
+                         EMPTY & PUSH_2_RANK & TARGETS;
+  uint64_t P_ATTACK_L = getPawnAttacksLeft<Us>(P) & ENEMY_PIECES & TARGETS;
+  uint64_t P_ATTACK_R = getPawnAttacksRight<Us>(P) & ENEMY_PIECES & TARGETS;
+
+  // Each promotion counts as 4 moves.
+  uint8_t n_moves = countSetBits(P_FORWARD) + countSetBits(P_FORWARD_2) +
+                    countSetBits(P_ATTACK_L) + countSetBits(P_ATTACK_R);
+  if ((P_FORWARD | P_ATTACK_L | P_ATTACK_R) & PROMOTION_RANK) {
+    n_moves += 3 * (countSetBits(P_FORWARD & PROMOTION_RANK) +
+                    countSetBits(P_ATTACK_L & PROMOTION_RANK) +
+                    countSetBits(P_ATTACK_R & PROMOTION_RANK));
+  }
+
+  uint64_t E_P = getEnPassantBitboard(en_passant);
+  if (shiftForward<Us == WHITE ? BLACK : WHITE>(E_P) & checker_zone) {
+    checker_zone |= E_P;
+  }
+  TARGETS = E_P & PINNED_MASK & checker_zone;
+  return n_moves + countSetBits(getPawnAttacksLeft<Us>(P) & TARGETS) +
+         countSetBits(getPawnAttacksRight<Us>(P) & TARGETS);
+}
+
+/** Counts the possible/legal moves of the active player Us, without writing
+ * them to a move list: the destinations of each piece are popcounted.
+ *
+ * @param game_state: Game state.
+ * @param attack_info: Attack information of the game state.
+ * @return Number of moves.
+ */
+template <Color Us>
+uint8_t countPlayerMoves(const GameState &game_state,
+                         const AttackInfo &attack_info) {
+  const uint64_t *player = game_state.pieces[Us];
+  uint64_t PIECES = game_state.occupancy[Us];
+  uint64_t ENEMY_PIECES = game_state.occupancy[Us ^ 1];
+  uint64_t OCCUPIED = PIECES | ENEMY_PIECES;
+  uint64_t K = player[KING];
+  uint8_t k_bit = getSetBit(K);
+  uint64_t PINNED = attack_info.pinned;
+  uint64_t checker_zone =
+      attack_info.n_checkers ? attack_info.checker_zone : FILLED;
+
+  uint8_t n_moves =
+      countSetBits(king_moves[k_bit] & ~PIECES & ~attack_info.danger_zone);
+  if (attack_info.n_checkers > 1) {
+    return n_moves;
+  }
+  if (!attack_info.n_checkers) {
+    n_moves +=
+        countCastleMoves<Us>(game_state, ~OCCUPIED, attack_info.danger_zone);
+  }
+
+  uint64_t P = player[PAWN];
+  uint64_t pinned_pawns = P & PINNED;
+  while (pinned_pawns) {
+    uint64_t bb = getLowestSetBitValue(pinned_pawns);
+    n_moves += countPawnMoves<Us>(line_mask[getSetBit(bb)][k_bit], bb,
+                                  game_state.en_passant, ~OCCUPIED,
+                                  ENEMY_PIECES, checker_zone);
+    clearLowestSetBit(pinned_pawns);
   }
+  n_moves += countPawnMoves<Us>(FILLED, P & ~PINNED, game_state.en_passant,
+                                ~OCCUPIED, ENEMY_PIECES, checker_zone);
 
-  generatePinnedPawnMoves(white_to_move, WP, WK, en_passant, EMPTY,
-                          BLACK_PIECES, PINNED, checker_zone, moves, n_moves);
+  uint64_t N = player[KNIGHT] & ~PINNED;
+  while (N) {
+    n_moves += countSetBits(knight_moves[getSetBit(getLowestSetBitValue(N))] &
+                            ~PIECES & checker_zone);
+    clearLowestSetBit(N);
+  }
 
-  if (WP) { // we have at least 1 non-pinned pawn
-    generatePawnMoves(white_to_move, FILLED, WP, WK, en_passant, EMPTY,
-                      BLACK_PIECES, checker_zone, moves, n_moves);
+  uint64_t SLIDERS = player[ROOK] | player[BISHOP] | player[QUEEN];
+  while (SLIDERS) {
+    uint64_t bb = getLowestSetBitValue(SLIDERS);
+    uint8_t bit = getSetBit(bb);
+    uint64_t targets = 0;
+    if (bb & (player[ROOK] | player[QUEEN])) {
+      targets |= horizontalAndVerticalMoves(bb, OCCUPIED);
+    }
+    if (bb & (player[BISHOP] | player[QUEEN])) {
+      targets |= diagonalMoves(bb, OCCUPIED);
+    }
+    uint64_t mask = bb & PINNED ? line_mask[bit][k_bit] : FILLED;
+    n_moves += countSetBits(targets & ~PIECES & mask & checker_zone);
+    clearLowestSetBit(SLIDERS);
   }
+  return n_moves;
+}
+
+uint8_t countMoves(const GameState &game_state,
+                   const AttackInfo &attack_info) {
+  return game_state.side_to_move == WHITE
+             ? countPlayerMoves<WHITE>(game_state, attack_info)
+             : countPlayerMoves<BLACK>(game_state, attack_info);
 }
 
-/** Generates the possible/legal moves for white.
+uint8_t countMoves(const GameState &game_state) {
+  AttackInfo attack_info;
+  computeAttackInfo(game_state, attack_info, false);
+  return countMoves(game_state, attack_info);
+}
+
+/** Checks that the move follows the movement rules of the piece on its initial
+ * square, and that its move type and capture flag match the position.
  *
  * @param game_state: Game state.
- * @param moves: Move list.
- * @param check: Returns true if the player is in check.
+ * @param move: Move.
+ * @return True if the move is pseudo-legal.
  */
-uint8_t generateBlackMoves(GameState &game_state, Move *moves, bool &check) {
-  uint64_t WHITE_PIECES = game_state.getWhiteOccupiedBitboard();
-  uint64_t BLACK_PIECES = game_state.getBlackOccupiedBitboard();
-  uint64_t OCCUPIED = BLACK_PIECES | WHITE_PIECES;
+template <Color Us>
+bool isPseudoLegal(const GameState &game_state, Move move) {
+  constexpr uint64_t PROMOTION_RANK = Us == WHITE ? rank_8 : rank_1;
+  constexpr uint64_t PUSH_2_RANK = Us == WHITE ? rank_4 : rank_5;
+  constexpr uint8_t SHIFT = BACK_RANK_SHIFT<Us>;
+
+  uint64_t PIECES = game_state.occupancy[Us];
+  uint64_t ENEMY_PIECES = game_state.occupancy[Us ^ 1];
+  uint64_t OCCUPIED = PIECES | ENEMY_PIECES;
+  uint64_t initial = move.getInitialBitboard();
+  uint64_t final = move.getFinalBitboard();
+  MoveType move_type = move.getMoveType();
+  if (!(initial & PIECES) || (final & PIECES)) {
+    return false;
+  }
 
-  uint64_t DZ = 0;
-  uint8_t n_checkers = 0;
-  uint64_t checker_zone = 0;
-  check = isInCheck(game_state.whites_turn, game_state.black.king,
-                    game_state.white, OCCUPIED, DZ, checker_zone, n_checkers);
+  PieceType piece = getPieceType(game_state.board[move.getFrom()]);
+  if (piece == PAWN) {
+    if (move_type == CASTLE_KINGSIDE || move_type == CASTLE_QUEENSIDE ||
+        bool(final & PROMOTION_RANK) != move.isPromotion()) {
+      return false;
+    }
+    uint64_t push = shiftForward<Us>(initial) & ~OCCUPIED;
+    if (move_type == PAWN_PUSH_2) {
+      return !move.isCapture() &&
+             (final & shiftForward<Us>(push) & ~OCCUPIED & PUSH_2_RANK);
+    }
+    if (final & push) {
+      return !move.isCapture();
+    }
+    uint64_t E_P = getEnPassantBitboard(game_state.en_passant);
+    return move.isCapture() &&
+           (final & getPawnAttackZone<Us>(initial) & (ENEMY_PIECES | E_P));
+  }
 
-  uint64_t PINNED = getPinnedPieces(
-      game_state.black.king, game_state.black.pawn, game_state.white.queen,
-      game_state.white.bishop, game_state.white.rook, OCCUPIED,
-      game_state.en_passant, game_state.whites_turn);
+  if (piece == KING && move_type == CASTLE_KINGSIDE) {
+    return !move.isCapture() && game_state.canKingSideCastle(Us) &&
+           move == Move(SHIFT + 4, SHIFT + 6, CASTLE_KINGSIDE) &&
+           !(KINGSIDE_CASTLE_PATH<Us> & OCCUPIED);
+  }
+  if (piece == KING && move_type == CASTLE_QUEENSIDE) {
+    return !move.isCapture() && game_state.canQueenSideCastle(Us) &&
+           move == Move(SHIFT + 4, SHIFT + 2, CASTLE_QUEENSIDE) &&
+           !(QUEENSIDE_CASTLE_EMPTY<Us> & OCCUPIED);
+  }
+  if (move_type != NONE || move.isCapture() != bool(final & ENEMY_PIECES)) {
+    return false;
+  }
 
-  uint8_t n_moves = 0;
-  if (!check) {
-    generateKingsideCastleMove(game_state.black.can_king_side_castle,
-                               game_state.black.king, ~OCCUPIED, DZ, moves,
-                               n_moves);
-    generateQueensideCastleMove(game_state.black.can_queen_side_castle,
-                                game_state.black.king, ~OCCUPIED, DZ, moves,
-                                n_moves);
+  uint8_t bit = move.getFrom();
+  switch (piece) {
+  case KNIGHT:
+    return final & knight_moves[bit];
+  case BISHOP:
+    return final & diagonalMoves(initial, OCCUPIED);
+  case ROOK:
+    return final & horizontalAndVerticalMoves(initial, OCCUPIED);
+  case QUEEN:
+    return final & (diagonalMoves(initial, OCCUPIED) |
+                    horizontalAndVerticalMoves(initial, OCCUPIED));
+  case KING:
+    return final & king_moves[bit];
+  default:
+    return false;
   }
+}
 
-  if (n_checkers < 2) {
-    generateBlackPawnMoves(game_state.whites_turn, game_state.black.pawn,
-                           game_state.black.king, game_state.en_passant,
-                           ~OCCUPIED, WHITE_PIECES, PINNED, checker_zone, moves,
-                           n_moves);
-    generateRookMoves(game_state.black.rook, game_state.black.king,
-                      BLACK_PIECES, OCCUPIED, PINNED, checker_zone, moves,
-                      n_moves);
-    generateBishopMoves(game_state.black.bishop, game_state.black.king,
-                        BLACK_PIECES, OCCUPIED, PINNED, checker_zone, moves,
-                        n_moves);
-    generateQueenMoves(game_state.black.queen, game_state.black.king,
-                       BLACK_PIECES, OCCUPIED, PINNED, checker_zone, moves,
-                       n_moves);
-    generateKnightMoves(game_state.black.knight, BLACK_PIECES, PINNED,
-                        checker_zone, moves, n_moves);
+bool isPseudoLegal(const GameState &game_state, Move move) {
+  return game_state.side_to_move == WHITE
+             ? isPseudoLegal<WHITE>(game_state, move)
+             : isPseudoLegal<BLACK>(game_state, move);
+}
+
+bool isLegal(const GameState &game_state, const AttackInfo &attack_info,
+             Move move) {
+  const uint64_t *player = game_state.pieces[game_state.getActiveColor()];
+  uint64_t initial = move.getInitialBitboard();
+  uint64_t final = move.getFinalBitboard();
+  uint64_t DZ = attack_info.danger_zone;
+
+  if (initial & player[KING]) {
+    uint64_t kingside_path = game_state.side_to_move == WHITE
+                                 ? KINGSIDE_CASTLE_PATH<WHITE>
+                                 : KINGSIDE_CASTLE_PATH<BLACK>;
+    uint64_t queenside_path = game_state.side_to_move == WHITE
+                                  ? QUEENSIDE_CASTLE_PATH<WHITE>
+                                  : QUEENSIDE_CASTLE_PATH<BLACK>;
+    switch (move.getMoveType()) {
+    case CASTLE_KINGSIDE:
+      return !attack_info.n_checkers && !(kingside_path & DZ);
+    case CASTLE_QUEENSIDE:
+      return !attack_info.n_checkers && !(queenside_path & DZ);
+    default:
+      return !(final & DZ);
+    }
+  }
+  if (attack_info.n_checkers > 1) {
+    return false;
   }
-  generateKingMoves(game_state.black.king, BLACK_PIECES, DZ, moves, n_moves);
 
-  return n_moves;
+  uint64_t resolved = final;
+  bool en_passant = (initial & player[PAWN]) && move.isCapture() &&
+                    !(final & game_state.occupied);
+  if (en_passant) {
+    // The en passant bit is cleared by updateCheckState() if the capture
+    // exposes the king along the rank.
+    if (final != getEnPassantBitboard(game_state.en_passant)) {
+      return false;
+    }
+    resolved |= game_state.side_to_move == WHITE ? final >> 8 : final << 8;
+  }
+  if (attack_info.n_checkers && !(resolved & attack_info.checker_zone)) {
+    return false;
+  }
+  return !(initial & attack_info.pinned) ||
+         (final & line_mask[move.getFrom()][getSetBit(player[KING])]);
 }
 
-/** Generates the possible/legal moves for white.
+bool isLegal(const GameState &game_state, Move move) {
+  if (!isPseudoLegal(game_state, move)) {
+    return false;
+  }
+  AttackInfo attack_info;
+  computeAttackInfo(game_state, attack_info, false);
+  return isLegal(game_state, attack_info, move);
+}
+
+/** Computes the check information of the position, for the active player Us.
  *
  * @param game_state: Game state.
- * @param moves: Move list.
- * @param check: Returns true if the player is in check.
+ * @param check_info: Check information to populate.
  */
-uint8_t generateWhiteMoves(GameState &game_state, Move *moves, bool &check) {
-  uint64_t WHITE_PIECES = game_state.getWhiteOccupiedBitboard();
-  uint64_t BLACK_PIECES = game_state.getBlackOccupiedBitboard();
-  uint64_t OCCUPIED = BLACK_PIECES | WHITE_PIECES;
+template <Color Us>
+void computeCheckInfo(const GameState &game_state, CheckInfo &check_info) {
+  constexpr Color Them = Us == WHITE ? BLACK : WHITE;
+  const uint64_t *player = game_state.pieces[Us];
+  const uint64_t *enemy = game_state.pieces[Us ^ 1];
+  uint64_t PIECES = game_state.occupancy[Us];
+  uint64_t OCCUPIED = game_state.occupied;
+  uint64_t EK = enemy[KING];
+  uint8_t ek_bit = getSetBit(EK);
+
+  // A pawn checks from the squares an enemy pawn on the king would attack.
+  check_info.check_squares[PAWN] = getPawnAttackZone<Them>(EK);
+  check_info.check_squares[KNIGHT] = knight_moves[ek_bit];
+  check_info.check_squares[BISHOP] = diagonalMoves(EK, OCCUPIED);
+  check_info.check_squares[ROOK] = horizontalAndVerticalMoves(EK, OCCUPIED);
+  check_info.check_squares[QUEEN] =
+      check_info.check_squares[BISHOP] | check_info.check_squares[ROOK];
+  check_info.check_squares[KING] = 0;
+
+  check_info.discovered_check_candidates = 0;
+  uint64_t snipers =
+      (horizontalAndVerticalMoves(EK, 0) & (player[ROOK] | player[QUEEN])) |
+      (diagonalMoves(EK, 0) & (player[BISHOP] | player[QUEEN]));
+  while (snipers) {
+    uint8_t bit = getSetBit(getLowestSetBitValue(snipers));
+    uint64_t blockers = between_mask[ek_bit][bit] & OCCUPIED;
+    if (countSetBits(blockers) == 1 && (blockers & PIECES)) {
+      check_info.discovered_check_candidates |= blockers;
+    }
+    clearLowestSetBit(snipers);
+  }
+}
 
-  uint64_t DZ = 0;
-  uint8_t n_checkers = 0;
-  uint64_t checker_zone = 0;
-  check = isInCheck(game_state.whites_turn, game_state.white.king,
-                    game_state.black, OCCUPIED, DZ, checker_zone, n_checkers);
+void computeCheckInfo(const GameState &game_state, CheckInfo &check_info) {
+  game_state.side_to_move == WHITE
+      ? computeCheckInfo<WHITE>(game_state, check_info)
+      : computeCheckInfo<BLACK>(game_state, check_info);
+}
 
-  uint64_t PINNED = getPinnedPieces(
-      game_state.white.king, game_state.white.pawn, game_state.black.queen,
-      game_state.black.bishop, game_state.black.rook, OCCUPIED,
-      game_state.en_passant, game_state.whites_turn);
+/** Returns true if the legal move of the active player Us puts the enemy king
+ * in check.
+ *
+ * @param game_state: Game state.
+ * @param check_info: Check information from computeCheckInfo().
+ * @param move: Legal move.
+ * @return True if the move gives check.
+ */
+template <Color Us>
+bool givesCheck(const GameState &game_state, const CheckInfo &check_info,
+                Move move) {
+  constexpr uint8_t SHIFT = BACK_RANK_SHIFT<Us>;
+  const uint64_t *player = game_state.pieces[Us];
+  const uint64_t *enemy = game_state.pieces[Us ^ 1];
+  uint64_t initial = move.getInitialBitboard();
+  uint64_t final = move.getFinalBitboard();
+  MoveType move_type = move.getMoveType();
+
+  // Direct check.
+  const PieceType piece = getPieceType(game_state.board[move.getFrom()]);
+  if (!move.isPromotion() && (final & check_info.check_squares[piece])) {
+    return true;
+  }
 
-  uint8_t n_moves = 0;
-  if (!check) {
-    generateKingsideCastleMove(game_state.white.can_king_side_castle,
-                               game_state.white.king, ~OCCUPIED, DZ, moves,
-                               n_moves);
-    generateQueensideCastleMove(game_state.white.can_queen_side_castle,
-                                game_state.white.king, ~OCCUPIED, DZ, moves,
-                                n_moves);
+  // Discovered check, unless the piece stays on the line to the enemy king.
+  uint8_t ek_bit = getSetBit(enemy[KING]);
+  if ((initial & check_info.discovered_check_candidates) &&
+      !(final & line_mask[move.getFrom()][ek_bit])) {
+    return true;
   }
 
-  if (n_checkers < 2) {
-    generateWhitePawnMoves(game_state.whites_turn, game_state.white.pawn,
-                           game_state.white.king, game_state.en_passant,
-                           ~OCCUPIED, BLACK_PIECES, PINNED, checker_zone, moves,
-                           n_moves);
-    generateRookMoves(game_state.white.rook, game_state.white.king,
-                      WHITE_PIECES, OCCUPIED, PINNED, checker_zone, moves,
-                      n_moves);
-    generateBishopMoves(game_state.white.bishop, game_state.white.king,
-                        WHITE_PIECES, OCCUPIED, PINNED, checker_zone, moves,
-                        n_moves);
-    generateQueenMoves(game_state.white.queen, game_state.white.king,
-                       WHITE_PIECES, OCCUPIED, PINNED, checker_zone, moves,
-                       n_moves);
-    generateKnightMoves(game_state.white.knight, WHITE_PIECES, PINNED,
-                        checker_zone, moves, n_moves);
+  uint64_t OCCUPIED = game_state.occupied;
+  switch (move_type) {
+  case PROMOTION_QUEEN:
+  case PROMOTION_ROOK:
+  case PROMOTION_BISHOP: {
+    // The promoted piece may check through the square the pawn left.
+    uint64_t occupied = (OCCUPIED & ~initial) | final;
+    uint64_t attacks = 0;
+    if (move_type != PROMOTION_BISHOP) {
+      attacks |= horizontalAndVerticalMoves(final, occupied);
+    }
+    if (move_type != PROMOTION_ROOK) {
+      attacks |= diagonalMoves(final, occupied);
+    }
+    return attacks & enemy[KING];
+  }
+  case PROMOTION_KNIGHT:
+    return final & check_info.check_squares[KNIGHT];
+  case CASTLE_KINGSIDE:
+  case CASTLE_QUEENSIDE: {
+    // The rook checks from its square next to the king.
+    bool kingside = move_type == CASTLE_KINGSIDE;
+    uint64_t rook = 1ULL << (SHIFT + (kingside ? 7 : 0));
+    uint64_t rook_final = 1ULL << (SHIFT + (kingside ? 5 : 3));
+    uint64_t occupied = (OCCUPIED & ~(initial | rook)) | final | rook_final;
+    return horizontalAndVerticalMoves(enemy[KING], occupied) & rook_final;
+  }
+  default:
+    break;
   }
-  generateKingMoves(game_state.white.king, WHITE_PIECES, DZ, moves, n_moves);
 
-  return n_moves;
+  // En passant can discover a check through the captured pawn's square.
+  if (move.isCapture() && piece == PAWN && !(final & OCCUPIED)) {
+    uint64_t captured = Us == WHITE ? final >> 8 : final << 8;
+    uint64_t occupied = (OCCUPIED & ~(initial | captured)) | final;
+    return (horizontalAndVerticalMoves(enemy[KING], occupied) &
+            (player[ROOK] | player[QUEEN])) ||
+           (diagonalMoves(enemy[KING], occupied) &
+            (player[BISHOP] | player[QUEEN]));
+  }
+  return false;
 }
 
-uint8_t generateMoves(GameState &game_state, Move *moves, bool &check) {
-  return game_state.whites_turn ? generateWhiteMoves(game_state, moves, check)
-                                : generateBlackMoves(game_state, moves, check);
+bool givesCheck(const GameState &game_state, const CheckInfo &check_info,
+                Move move) {
+  return game_state.side_to_move == WHITE
+             ? givesCheck<WHITE>(game_state, check_info, move)
+             : givesCheck<BLACK>(game_state, check_info, move);
 }
 
 void print_moves(bool white_to_move, Move *moves, uint8_t n_moves) {
@@ -1,12 +1,123 @@
 #pragma once
 
 #include "board.h"
+#include "constants.h"
 #include "move.h"
 #include <stdint.h>
 
-/** Initializes the magic bitboard tables.
+// Backends of the slider (rook/bishop/queen) move lookups.
+enum SliderBackend : uint8_t {
+  // Magic bitboards: multiply and shift. Portable.
+  MAGIC_BACKEND = 0,
+  // BMI2 PEXT instruction. Only on CPUs where it is fast.
+  PEXT_BACKEND = 1,
+};
+
+/** Selects the backend of the slider move lookups. By default, PEXT is picked
+ * at startup if the CPU supports it.
+ *
+ * @param backend: Slider backend.
+ * @return True if the backend is available on this CPU and was selected.
+ */
+bool setSliderBackend(SliderBackend backend);
+
+/** Returns the backend of the slider move lookups.
+ *
+ * @return Slider backend.
+ */
+SliderBackend getSliderBackend(void);
+
+/** Attack information of a position. Computed once per node, and shared
+ * between the move generator and the evaluation. Not zero initialized, as it
+ * is created at every node; computeAttackInfo() populates it.
+ */
+struct AttackInfo {
+  // Squares attacked by each piece type, per color.
+  uint64_t attacks[N_COLORS][N_PIECE_TYPES];
+
+  // Squares attacked by all pieces, per color.
+  uint64_t all_attacks[N_COLORS];
+
+  // Squares the active player's king cannot move to. Enemy sliders see through
+  // the king, so it cannot step back along the line of a check.
+  uint64_t danger_zone;
+
+  // Enemy pieces putting the active player's king in check.
+  uint64_t checkers;
+
+  // Squares that resolve a single check (the checker and the line between it
+  // and the king). 0 if not in check.
+  uint64_t checker_zone;
+
+  // The number of pieces putting the active player's king in check.
+  uint8_t n_checkers;
+
+  // The active player's pieces that are pinned to their king.
+  uint64_t pinned;
+};
+
+/** Check information of a position: the squares each piece type of the active
+ * player gives check from, and the active player's pieces that discover a
+ * check by moving off the line between one of its sliders and the enemy king.
+ * Computed once per node, then shared by givesCheck() for each move.
+ */
+struct CheckInfo {
+  // Squares from which each piece type attacks the enemy king.
+  uint64_t check_squares[N_PIECE_TYPES];
+
+  // The active player's pieces that are the only blocker between one of its
+  // sliders and the enemy king.
+  uint64_t discovered_check_candidates;
+};
+
+/** Computes the check information of the position.
+ *
+ * @param game_state: Game state.
+ * @param check_info: Check information to populate.
+ */
+void computeCheckInfo(const GameState &game_state, CheckInfo &check_info);
+
+/** Returns true if the legal move puts the enemy king in check, without
+ * applying the move.
+ *
+ * @param game_state: Game state.
+ * @param check_info: Check information from computeCheckInfo().
+ * @param move: Legal move.
+ * @return True if the move gives check.
+ */
+bool givesCheck(const GameState &game_state, const CheckInfo &check_info,
+                Move move);
+
+/** Updates the cached checkers and pinned pieces of the position, for the side
+ * to move. Also clears the en passant bit if the en passant capture would
+ * expose the king to a horizontal check. Called by applyMove() and
+ * fenToGameState(); call it after editing the bitboards directly.
+ *
+ * @param game_state: Game state.
+ */
+void updateCheckState(GameState &game_state);
+
+/** Computes the attack information of the position. The checkers and pinned
+ * pieces are taken from the position's cache.
+ *
+ * @param game_state: Game state.
+ * @param attack_info: Attack information to populate.
+ * @param active_player_attacks: If false, only the information needed for move
+ * legality is computed. The active player's all_attacks is set to 0 and its
+ * per piece type attacks are left unset.
+ */
+void computeAttackInfo(const GameState &game_state, AttackInfo &attack_info,
+                       bool active_player_attacks = true);
+
+/** Generates the possible/legal moves, using precomputed attack information.
+ *
+ * @param game_state: Game state.
+ * @param attack_info: Attack information from computeAttackInfo().
+ * @param moves: Move list.
+ * @return Number of moves.
  */
-void initializeMagicBitboardTables(void);
+uint8_t generateMoves(GameState &game_state, const AttackInfo &attack_info,
+                      Move *moves);
 
 /** Generates the possible/legal moves.
  *
@@ -17,6 +128,58 @@ void initializeMagicBitboardTables(void);
  */
 uint8_t generateMoves(GameState &game_state, Move *moves, bool &check);
 
+/** Counts the possible/legal moves, using precomputed attack information.
+ * Cheaper than generateMoves(), as no move list is written.
+ *
+ * @param game_state: Game state.
+ * @param attack_info: Attack information from computeAttackInfo().
+ * @return Number of moves.
+ */
+uint8_t countMoves(const GameState &game_state, const AttackInfo &attack_info);
+
+/** Counts the possible/legal moves.
+ *
+ * @param game_state: Game state.
+ * @return Number of moves.
+ */
+uint8_t countMoves(const GameState &game_state);
+
+/** Checks that the move follows the movement rules of the piece on its initial
+ * square, and that its move type and capture flag match the position. The king
+ * may still be left in check. For moves that do not come from the move
+ * generator, e.g. hash moves, killer moves or moves received over UCI.
+ *
+ * @param game_state: Game state.
+ * @param move: Move.
+ * @return True if the move is pseudo-legal.
+ */
+bool isPseudoLegal(const GameState &game_state, Move move);
+
+/** Checks that a pseudo-legal move does not leave the king in check, using
+ * precomputed attack information.
+ *
+ * @param game_state: Game state.
+ * @param attack_info: Attack information from computeAttackInfo().
+ * @param move: Pseudo-legal move.
+ * @return True if the move is legal.
+ */
+bool isLegal(const GameState &game_state, const AttackInfo &attack_info,
+             Move move);
+
+/** Checks that the move is legal. A move is legal if and only if it is
+ * generated by generateMoves().
+ *
+ * @param game_state: Game state.
+ * @param move: Move.
+ * @return True if the move is legal.
+ */
+bool isLegal(const GameState &game_state, Move move);
+
+/** Searches new magic numbers for the slider tables, and prints them as the
+ * bishop_magic_numbers/rook_magic_numbers arrays of src/constants.h.
+ */
+void printMagicNumbers(void);
+
 /** Prints the move list.
  *
  * @param white_to_move: Flag denoting the turn.
@@ -0,0 +1,186 @@
+#include "packed_position.h"
+#include "board.h"
+#include "constants.h"
+#include "helper_functions.h"
+#include "move_generator.h"
+#include <algorithm>
+#include <iostream>
+
+// Number of records read or written at a time.
+const size_t PACKED_POSITION_BUFFER_SIZE = 4096;
+
+const uint16_t HALFMOVE_CLOCK_MAX = 127;
+const uint16_t FULLMOVE_NUMBER_MAX = 16383;
+
+bool packPosition(const PositionRecord &record, PackedPosition &packed) {
+  const GameState &game_state = record.game_state;
+  if (countSetBits(game_state.occupied) > 32) {
+    return false;
+  }
+
+  packed = PackedPosition();
+  packed.occupied = game_state.occupied;
+  uint64_t OCCUPIED = game_state.occupied;
+  for (uint8_t i = 0; OCCUPIED; i++) {
+    uint8_t square = getSetBit(getLowestSetBitValue(OCCUPIED));
+    packed.pieces[i / 2] |= game_state.board[square] << (i % 2 * 4);
+    clearLowestSetBit(OCCUPIED);
+  }
+
+  packed.state = game_state.side_to_move | game_state.castling_rights << 1;
+  if (game_state.en_passant >= 0) {
+    packed.state |= 1 << 5 | (game_state.en_passant % 8) << 6;
+  }
+  packed.state |=
+      std::min(game_state.halfmove_clock, HALFMOVE_CLOCK_MAX) << 9;
+  packed.fullmove_number_and_result =
+      std::min(game_state.fullmove_number, FULLMOVE_NUMBER_MAX) |
+      record.result << 14;
+  packed.score = record.score;
+  packed.move = record.move.getData();
+  return true;
+}
+
+bool unpackPosition(const PackedPosition &packed, PositionRecord &record) {
+  GameState game_state;
+  uint64_t OCCUPIED = packed.occupied;
+  for (uint8_t i = 0; OCCUPIED; i++) {
+    if (i == 32) {
+      return false;
+    }
+    uint64_t bb = getLowestSetBitValue(OCCUPIED);
+    Piece piece = Piece((packed.pieces[i / 2] >> (i % 2 * 4)) & 0xF);
+    PieceType piece_type = getPieceType(piece);
+    if (piece_type >= N_PIECE_TYPES) {
+      return false;
+    }
+    Color color = getPieceColor(piece);
+    game_state.pieces[color][piece_type] |= bb;
+    game_state.occupancy[color] |= bb;
+    game_state.board[getSetBit(bb)] = piece;
+    clearLowestSetBit(OCCUPIED);
+  }
+  game_state.occupied = packed.occupied;
+  // The check state needs exactly one king per side.
+  if (!hasPossiblePieceCounts(game_state)) {
+    return false;
+  }
+
+  uint16_t state = packed.state;
+  game_state.side_to_move = Color(state & 1);
+  // Like in a FEN, impossible castling rights are dropped and an impossible
+  // en passant square is an error.
+  game_state.castling_rights = (state >> 1) & ALL_CASTLING;
+  dropImpossibleCastlingRights(game_state);
+  if (state & (1 << 5)) {
+    uint8_t square =
+        (game_state.side_to_move == WHITE ? 40 : 16) + ((state >> 6) & 7);
+    if (!isPossibleEnPassant(game_state, square)) {
+      return false;
+    }
+    game_state.en_passant = square;
+  }
+  game_state.halfmove_clock = state >> 9;
+  game_state.fullmove_number =
+      packed.fullmove_number_and_result & FULLMOVE_NUMBER_MAX;
+  updateCheckState(game_state);
+
+  record.game_state = game_state;
+  record.result = GameResult(packed.fullmove_number_and_result >> 14);
+  record.score = packed.score;
+  record.move = Move::fromData(packed.move);
+  return true;
+}
+
+GameResult parseGameResult(std::string_view text) {
+  auto contains = [text](std::string_view substr) {
+    return text.find(substr) != std::string_view::npos;
+  };
+  if (contains("1/2-1/2") || contains("[0.5]")) {
+    return RESULT_DRAW;
+  }
+  if (contains("1-0") || contains("[1.0]")) {
+    return RESULT_WHITE_WIN;
+  }
+  if (contains("0-1") || contains("[0.0]")) {
+    return RESULT_BLACK_WIN;
+  }
+  return RESULT_NONE;
+}
+
+PackedPositionWriter::PackedPositionWriter(const std::string &path)
+    : file(path, std::ios::binary | std::ios::trunc) {
+  buffer.reserve(PACKED_POSITION_BUFFER_SIZE);
+}
+
+bool PackedPositionWriter::write(const PositionRecord &record) {
+  PackedPosition packed;
+  if (!packPosition(record, packed)) {
+    return false;
+  }
+  buffer.push_back(packed);
+  if (buffer.size() == PACKED_POSITION_BUFFER_SIZE) {
+    flush();
+  }
+  return true;
+}
+
+void PackedPositionWriter::flush(void) {
+  file.write(reinterpret_cast<const char *>(buffer.data()),
+             buffer.size() * sizeof(PackedPosition));
+  file.flush();
+  buffer.clear();
+}
+
+PackedPositionReader::PackedPositionReader(const std::string &path)
+    : file(path, std::ios::binary), buffer(PACKED_POSITION_BUFFER_SIZE) {}
+
+bool PackedPositionReader::read(PositionRecord &record) {
+  while (true) {
+    if (next == n_buffered) {
+      file.read(reinterpret_cast<char *>(buffer.data()),
+                buffer.size() * sizeof(PackedPosition));
+      // A truncated record at the end of the file is ignored.
+      n_buffered = file.gcount() / sizeof(PackedPosition);
+      next = 0;
+      if (!n_buffered) {
+        return false;
+      }
+    }
+    if (unpackPosition(buffer[next++], record)) {
+      return true;
+    }
+    n_invalid++;
+  }
+}
+
+void packPositionFile(const std::string &input_path,
+                      const std::string &output_path) {
+  std::ifstream input(input_path);
+  if (!input) {
+    logErrorAndExit("ERROR: Could not open " + input_path + ".");
+  }
+  PackedPositionWriter writer(output_path);
+  if (!writer.isOpen()) {
+    logErrorAndExit("ERROR: Could not create " + output_path + ".");
+  }
+
+  uint64_t n_packed = 0;
+  uint64_t n_skipped = 0;
+  std::string line;
+  while (std::getline(input, line)) {
+    std::string_view text = line;
+    size_t fen_length = getFenLength(text);
+    PositionRecord record;
+    if (!fen_length ||
+        fenToGameState(text.substr(0, fen_length), record.game_state) !=
+            FEN_OK) {
+      n_skipped += !line.empty();
+      continue;
+    }
+    record.result = parseGameResult(text.substr(fen_length));
+    writer.write(record) ? n_packed++ : n_skipped++;
+  }
+  std::cout << "Packed positions: " << n_packed << ", skipped lines: "
+            << n_skipped << "." << std::endl;
+}
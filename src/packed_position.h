@@ -0,0 +1,150 @@
+#pragma once
+
+#include "board.h"
+#include "move.h"
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// File extension of packed position files.
+const std::string PACKED_POSITION_EXTENSION = ".vpos";
+
+// Score of a position record without a score.
+const int16_t NO_SCORE = INT16_MIN;
+
+enum GameResult : uint8_t {
+  RESULT_NONE = 0,
+  RESULT_BLACK_WIN = 1,
+  RESULT_DRAW = 2,
+  RESULT_WHITE_WIN = 3
+};
+
+/** Position with optional annotations, as stored in a packed position file. */
+struct PositionRecord {
+  GameState game_state;
+  GameResult result = RESULT_NONE;
+  int16_t score = NO_SCORE;
+  // Move played or best move, Move() if none.
+  Move move;
+};
+
+/** Fixed size encoding of a position record. Files are plain arrays of these,
+ * in host byte order.
+ */
+struct PackedPosition {
+  // Occupied squares.
+  uint64_t occupied;
+
+  // Piece on each occupied square, in square order, 4 bits each (the Piece
+  // value). The first piece is in the low bits of the first byte.
+  uint8_t pieces[16];
+
+  // Bits: 0: black to move, 1 - 4: castling rights (white king side, white
+  // queen side, black king side, black queen side), 5: en passant available,
+  // 6 - 8: en passant file, 9 - 15: halfmove clock, capped at 127.
+  uint16_t state;
+
+  // Bits: 0 - 13: fullmove number, capped at 16383, 14 - 15: game result.
+  uint16_t fullmove_number_and_result;
+
+  int16_t score;
+
+  // Move data, see Move.
+  uint16_t move;
+};
+
+static_assert(sizeof(PackedPosition) == 32);
+
+/** Packs a position record.
+ *
+ * @param record: Position record.
+ * @param packed: Packed position, populated by this function.
+ * @return False if the position has more than 32 pieces.
+ */
+bool packPosition(const PositionRecord &record, PackedPosition &packed);
+
+/** Unpacks a position record.
+ *
+ * @param packed: Packed position.
+ * @param record: Position record, populated by this function.
+ * @return False if the packed position holds an invalid piece code,
+ * impossible piece counts such as a missing king, or an impossible en passant
+ * square. Impossible castling rights are dropped.
+ */
+bool unpackPosition(const PackedPosition &packed, PositionRecord &record);
+
+/** Parses a game result, either as "1-0", "0-1", "1/2-1/2" (e.g. EPD "c9"
+ * opcode) or as "[1.0]", "[0.5]", "[0.0]", anywhere in the text.
+ *
+ * @param text: Text.
+ * @return Game result, RESULT_NONE if none was found.
+ */
+GameResult parseGameResult(std::string_view text);
+
+/** Buffered writer of a packed position file. */
+class PackedPositionWriter {
+public:
+  /** Creates the file, replacing it if it exists.
+   *
+   * @param path: Path of the file.
+   */
+  PackedPositionWriter(const std::string &path);
+
+  ~PackedPositionWriter() { flush(); }
+
+  bool isOpen(void) const { return file.is_open(); }
+
+  /** Appends a position record.
+   *
+   * @param record: Position record.
+   * @return False if the position cannot be packed.
+   */
+  bool write(const PositionRecord &record);
+
+  /** Writes out the buffered records. */
+  void flush(void);
+
+private:
+  std::ofstream file;
+  std::vector<PackedPosition> buffer;
+};
+
+/** Buffered reader of a packed position file. */
+class PackedPositionReader {
+public:
+  /** Opens the file.
+   *
+   * @param path: Path of the file.
+   */
+  PackedPositionReader(const std::string &path);
+
+  bool isOpen(void) const { return file.is_open(); }
+
+  /** Reads the next valid position record. Invalid records are skipped.
+   *
+   * @param record: Position record, populated by this function.
+   * @return False at the end of the file.
+   */
+  bool read(PositionRecord &record);
+
+  /** Returns the number of invalid records skipped so far. */
+  uint64_t getInvalidCount(void) const { return n_invalid; }
+
+private:
+  std::ifstream file;
+  std::vector<PackedPosition> buffer;
+  size_t n_buffered = 0;
+  size_t next = 0;
+  uint64_t n_invalid = 0;
+};
+
+/** Converts a text file of positions to a packed position file. Each line
+ * holds a FEN, optionally followed by a game result (see parseGameResult()).
+ *
+ * @param input_path: Path of the text file.
+ * @param output_path: Path of the packed position file.
+ */
+void packPositionFile(const std::string &input_path,
+                      const std::string &output_path);
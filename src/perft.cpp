@@ -0,0 +1,240 @@
+#include "perft.h"
+#include "board.h"
+#include "constants.h"
+#include "move_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+const uint64_t PERFT_NODES_MASK = (1ULL << 56) - 1;
+
+PerftHashTable::PerftHashTable(uint32_t size_mb) {
+  uint64_t n_entries = 1;
+  while (n_entries * 2 * sizeof(Entry) <= (uint64_t)size_mb << 20) {
+    n_entries *= 2;
+  }
+  entries = std::vector<Entry>(n_entries);
+  index_mask = n_entries - 1;
+}
+
+bool PerftHashTable::probe(uint64_t hash, uint8_t depth,
+                           uint64_t &nodes) const {
+  const Entry &entry = entries[hash & index_mask];
+  uint64_t data = entry.data.load(std::memory_order_relaxed);
+  uint64_t key = entry.key.load(std::memory_order_relaxed);
+  if ((key ^ data) != hash || (data >> 56) != depth) {
+    return false;
+  }
+  nodes = data & PERFT_NODES_MASK;
+  return true;
+}
+
+void PerftHashTable::store(uint64_t hash, uint8_t depth, uint64_t nodes) {
+  Entry &entry = entries[hash & index_mask];
+  uint64_t data = ((uint64_t)depth << 56) | (nodes & PERFT_NODES_MASK);
+  entry.key.store(hash ^ data, std::memory_order_relaxed);
+  entry.data.store(data, std::memory_order_relaxed);
+}
+
+uint64_t perft(GameState &game_state, uint8_t depth,
+               PerftHashTable *hash_table) {
+  if (depth == 0) {
+    return 1;
+  }
+
+  uint64_t hash = 0;
+  uint64_t nodes = 0;
+  // Leaf parents are bulk counted, which is cheaper than a hash probe.
+  if (hash_table && depth > 1) {
+    hash = getPositionHash(game_state);
+    if (hash_table->probe(hash, depth, nodes)) {
+      return nodes;
+    }
+  }
+
+  if (depth == 1) {
+    return countMoves(game_state);
+  }
+
+  bool check;
+  Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+  uint8_t n_moves = generateMoves(game_state, moves, check);
+
+  for (uint8_t i = 0; i < n_moves; i++) {
+    GameState child = game_state;
+    applyMove(moves[i], child);
+    nodes += perft(child, depth - 1, hash_table);
+  }
+
+  if (hash_table) {
+    hash_table->store(hash, depth, nodes);
+  }
+  return nodes;
+}
+
+// A subtree to count, below the root move with index root_move.
+struct PerftTask {
+  GameState game_state;
+  uint8_t depth;
+  uint8_t root_move;
+};
+
+// Task queue of one thread. The owner pops tasks from the back, other threads
+// steal from the front.
+struct PerftTaskQueue {
+  std::mutex mutex;
+  std::deque<PerftTask> tasks;
+};
+
+/** Splits the tree into subtrees, one ply at a time, until there are enough
+ * tasks to balance the threads or the subtrees get too small.
+ *
+ * @param game_state: Game state.
+ * @param depth: Depth to count to, at least 1.
+ * @param n_threads: Number of threads.
+ * @param moves: Root moves, populated by this function.
+ * @param n_moves: Number of root moves, populated by this function.
+ * @return Tasks.
+ */
+std::vector<PerftTask> splitPerft(GameState &game_state, uint8_t depth,
+                                  uint32_t n_threads, Move *moves,
+                                  uint8_t &n_moves) {
+  const uint32_t TASKS_PER_THREAD = 16;
+  // Subtrees of this depth are counted as a whole.
+  const uint8_t MIN_SPLIT_DEPTH = 3;
+
+  bool check;
+  n_moves = generateMoves(game_state, moves, check);
+  std::vector<PerftTask> tasks;
+  for (uint8_t i = 0; i < n_moves; i++) {
+    tasks.push_back({game_state, uint8_t(depth - 1), i});
+    applyMove(moves[i], tasks.back().game_state);
+  }
+
+  while (!tasks.empty() && tasks.size() < n_threads * TASKS_PER_THREAD &&
+         tasks.front().depth >= MIN_SPLIT_DEPTH) {
+    std::vector<PerftTask> children;
+    for (PerftTask &task : tasks) {
+      Move child_moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+      uint8_t n_child_moves =
+          generateMoves(task.game_state, child_moves, check);
+      for (uint8_t i = 0; i < n_child_moves; i++) {
+        children.push_back(
+            {task.game_state, uint8_t(task.depth - 1), task.root_move});
+        applyMove(child_moves[i], children.back().game_state);
+      }
+    }
+    tasks.swap(children);
+  }
+  return tasks;
+}
+
+/** Pops a task from the thread's own queue, or steals one from another thread.
+ *
+ * @param queues: Task queues, one per thread.
+ * @param thread: Index of the thread.
+ * @param task: Task, populated by this function.
+ * @return False if all the queues are empty.
+ */
+bool getPerftTask(std::vector<PerftTaskQueue> &queues, uint32_t thread,
+                  PerftTask &task) {
+  for (uint32_t i = 0; i < queues.size(); i++) {
+    PerftTaskQueue &queue = queues[(thread + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+    } else {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+    }
+    return true;
+  }
+  return false;
+}
+
+std::vector<uint64_t> parallelPerft(GameState &game_state, uint8_t depth,
+                                    uint32_t n_threads, Move *moves,
+                                    PerftHashTable *hash_table) {
+  n_threads = std::max(1u, n_threads);
+  uint8_t n_moves;
+  std::vector<PerftTask> tasks =
+      splitPerft(game_state, depth, n_threads, moves, n_moves);
+
+  // Tasks are dealt out round robin, so each queue starts with subtrees from
+  // all over the tree. No tasks are added after the split, so a thread is
+  // done once every queue is empty.
+  std::vector<PerftTaskQueue> queues(n_threads);
+  for (uint32_t i = 0; i < tasks.size(); i++) {
+    queues[i % n_threads].tasks.push_back(tasks[i]);
+  }
+
+  // Node counts per thread per root move.
+  std::vector<std::vector<uint64_t>> thread_nodes(
+      n_threads, std::vector<uint64_t>(n_moves, 0));
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < n_threads; i++) {
+    threads.emplace_back([&, i]() {
+      PerftTask task;
+      while (getPerftTask(queues, i, task)) {
+        thread_nodes[i][task.root_move] +=
+            perft(task.game_state, task.depth, hash_table);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<uint64_t> nodes(n_moves, 0);
+  for (const std::vector<uint64_t> &counts : thread_nodes) {
+    for (uint8_t i = 0; i < n_moves; i++) {
+      nodes[i] += counts[i];
+    }
+  }
+  return nodes;
+}
+
+void runPerft(const std::string &fen, uint8_t depth, uint32_t hash_mb,
+              uint32_t n_threads, bool divide) {
+  GameState game_state;
+  FenError error = fenToGameState(fen, game_state);
+  if (error != FEN_OK) {
+    std::cout << "Invalid FEN: " << fenErrorToString(error) << "." << std::endl;
+    return;
+  }
+  PerftHashTable table(hash_mb);
+  PerftHashTable *hash_table = hash_mb ? &table : nullptr;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  uint64_t nodes = 0;
+  if (depth > 0 && (divide || n_threads > 1)) {
+    Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+    std::vector<uint64_t> move_nodes =
+        parallelPerft(game_state, depth, n_threads, moves, hash_table);
+    for (uint8_t i = 0; i < move_nodes.size(); i++) {
+      if (divide) {
+        std::cout << moves[i].toString() << ": " << move_nodes[i] << std::endl;
+      }
+      nodes += move_nodes[i];
+    }
+    if (divide) {
+      std::cout << std::endl;
+    }
+  } else {
+    nodes = perft(game_state, depth, hash_table);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double seconds = (double)(end - start).count() / 1000000000;
+
+  std::cout << "Nodes searched: " << nodes << "." << std::endl;
+  std::cout << "Time elapsed: " << seconds << " s." << std::endl;
+  std::cout << "NPS: " << nodes / seconds << std::endl;
+}
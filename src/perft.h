@@ -0,0 +1,90 @@
+#pragma once
+
+#include "board.h"
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/** Perft hash table, keyed by the position hash and the remaining depth. Each
+ * entry stores the number of leaf nodes below the position. Always replaces.
+ *
+ * The table can be shared between threads without locks: the key is stored
+ * xor'ed with the data, so an entry torn by concurrent writes fails the key
+ * check and is treated as a miss.
+ */
+class PerftHashTable {
+public:
+  /** Allocates the table. The number of entries is rounded down to a power of
+   * 2.
+   *
+   * @param size_mb: Size of the table, in MB.
+   */
+  PerftHashTable(uint32_t size_mb);
+
+  /** Looks up the node count of the position.
+   *
+   * @param hash: Hash of the position.
+   * @param depth: Remaining depth.
+   * @param nodes: Node count, populated by this function if found.
+   * @return True if the position was found.
+   */
+  bool probe(uint64_t hash, uint8_t depth, uint64_t &nodes) const;
+
+  /** Stores the node count of the position.
+   *
+   * @param hash: Hash of the position.
+   * @param depth: Remaining depth.
+   * @param nodes: Node count.
+   */
+  void store(uint64_t hash, uint8_t depth, uint64_t nodes);
+
+private:
+  struct Entry {
+    // Hash of the position xor'ed with the data.
+    std::atomic<uint64_t> key{0};
+    // Node count in the low 56 bits, depth in the high 8 bits. Depth 0 marks
+    // an empty entry.
+    std::atomic<uint64_t> data{0};
+  };
+  std::vector<Entry> entries;
+  uint64_t index_mask = 0;
+};
+
+/** Counts the leaf nodes of the game tree to the given depth. Moves are bulk
+ * counted at depth 1 with countMoves(), instead of being generated and
+ * applied.
+ *
+ * @param game_state: Game state.
+ * @param depth: Depth to count to.
+ * @param hash_table: Optional perft hash table.
+ * @return Number of leaf nodes.
+ */
+uint64_t perft(GameState &game_state, uint8_t depth,
+               PerftHashTable *hash_table = nullptr);
+
+/** Counts the leaf nodes below each root move with multiple threads. The tree
+ * is split into subtrees near the root, which are distributed over per-thread
+ * work-stealing queues. Each thread sums its node counts separately.
+ *
+ * @param game_state: Game state.
+ * @param depth: Depth to count to, at least 1.
+ * @param n_threads: Number of threads.
+ * @param moves: Root moves, populated by this function.
+ * @param hash_table: Optional perft hash table, shared by the threads.
+ * @return Number of leaf nodes below each root move.
+ */
+std::vector<uint64_t> parallelPerft(GameState &game_state, uint8_t depth,
+                                    uint32_t n_threads, Move *moves,
+                                    PerftHashTable *hash_table = nullptr);
+
+/** Runs perft on the position and prints the node count and NPS.
+ *
+ * @param fen: FEN string.
+ * @param depth: Depth to count to.
+ * @param hash_mb: Size of the perft hash table in MB, 0 to disable it.
+ * @param n_threads: Number of threads.
+ * @param divide: If true, also prints the node count below each root move.
+ */
+void runPerft(const std::string &fen, uint8_t depth, uint32_t hash_mb,
+              uint32_t n_threads, bool divide);
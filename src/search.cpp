@@ -3,12 +3,69 @@
 #include "constants.h"
 #include "evaluate.h"
 #include "move_generator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <utility>
+
+/** Scores the moves for move ordering: captures by most valuable victim, then
+ * least valuable attacker, and promotions by the promoted piece. Quiet moves
+ * score 0.
+ *
+ * @param game_state: Game state.
+ * @param moves: Move list.
+ * @param n_moves: Number of moves.
+ * @param scored_moves: Scored move list, populated by this function.
+ */
+void scoreMoves(const GameState &game_state, const Move *moves,
+                uint8_t n_moves, ScoredMove *scored_moves) {
+  for (uint8_t i = 0; i < n_moves; i++) {
+    Move move = moves[i];
+    int16_t score = 0;
+    if (move.isCapture()) {
+      // En passant captures have an empty final square, and capture a pawn.
+      Piece victim = game_state.board[move.getTo()];
+      PieceType attacker = getPieceType(game_state.board[move.getFrom()]);
+      score += 16 * ((victim == NO_PIECE ? PAWN : getPieceType(victim)) + 1) -
+               attacker;
+    }
+    if (move.getMoveType() == PROMOTION_QUEEN) {
+      score += 16 * QUEEN;
+    }
+    scored_moves[i] = {move, score};
+  }
+}
+
+/** Swaps the highest scoring move of the remaining moves to the front.
+ *
+ * @param scored_moves: Scored move list.
+ * @param begin: Index of the first remaining move.
+ * @param n_moves: Number of moves.
+ */
+void pickNextMove(ScoredMove *scored_moves, uint8_t begin, uint8_t n_moves) {
+  uint8_t best = begin;
+  for (uint8_t i = begin + 1; i < n_moves; i++) {
+    if (scored_moves[i].score > scored_moves[best].score) {
+      best = i;
+    }
+  }
+  std::swap(scored_moves[begin], scored_moves[best]);
+}
 
 NegamaxTuple negamax(GameState game_state, uint8_t depth, int8_t color,
-                     int16_t alpha, int16_t beta) {
+                     int16_t alpha, int16_t beta, PrincipalVariation *pv) {
+  if (pv) {
+    pv->length = 0;
+  }
+
   // Terminal Node.
   if (depth == 0) {
-    return NegamaxTuple(Move(), evaluatePosition(game_state) * color, 1);
+    // The evaluation is from white's perspective, flip the window for black.
+    int16_t score = color == 1
+                        ? evaluatePosition(game_state, alpha, beta)
+                        : -evaluatePosition(game_state, -beta, -alpha);
+    return NegamaxTuple(Move(), score, 1);
   }
 
   bool check = false;
@@ -21,25 +78,99 @@ NegamaxTuple negamax(GameState game_state, uint8_t depth, int8_t color,
   }
 
   NegamaxTuple node_max = NegamaxTuple(Move(), INT16_MIN, 1);
+  ScoredMove scored_moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+  scoreMoves(game_state, moves, n_moves, scored_moves);
 
   for (uint8_t i = 0; i < n_moves; i++) {
+    pickNextMove(scored_moves, i, n_moves);
+    Move move = scored_moves[i].move;
     GameState game_state_temp;
     memcpy(&game_state_temp, &game_state, sizeof(GameState));
-    applyMove(moves[i], game_state_temp);
+    applyMove(move, game_state_temp);
     NegamaxTuple node_temp =
-        negamax(game_state_temp, depth - 1, -color, -beta, -alpha);
+        negamax(game_state_temp, depth - 1, -color, -beta, -alpha,
+                pv ? pv + 1 : nullptr);
     node_temp.score *= -1;
     node_max.nodes_searched += node_temp.nodes_searched;
 
     if (node_temp.score > node_max.score) {
       node_max.score = node_temp.score;
-      node_max.move = moves[i];
+      node_max.move = move;
+      if (pv) {
+        pv->moves[0] = move;
+        std::copy(pv[1].moves, pv[1].moves + pv[1].length, pv->moves + 1);
+        pv->length = pv[1].length + 1;
+      }
     }
 
     alpha = std::max(alpha, node_temp.score);
     if (alpha >= beta) {
-      return NegamaxTuple(node_max.move, alpha, 1);
+      return NegamaxTuple(node_max.move, alpha, node_max.nodes_searched);
     }
   }
   return node_max;
 }
+
+std::vector<RootMove> searchRootMoves(const GameState &game_state,
+                                      uint8_t depth, uint32_t n_threads,
+                                      uint8_t n_lines,
+                                      uint64_t &nodes_searched) {
+  bool check = false;
+  GameState root = game_state;
+  Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+  uint8_t n_moves = generateMoves(root, moves, check);
+  ScoredMove scored_moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+  scoreMoves(game_state, moves, n_moves, scored_moves);
+  std::vector<RootMove> root_moves(n_moves);
+  for (uint8_t i = 0; i < n_moves; i++) {
+    pickNextMove(scored_moves, i, n_moves);
+    root_moves[i].move = scored_moves[i].move;
+  }
+
+  const int8_t color = game_state.side_to_move == WHITE ? 1 : -1;
+  std::atomic<uint8_t> next_move = 0;
+  std::atomic<int16_t> best_score = -INT16_MAX;
+  std::atomic<uint64_t> nodes = 0;
+  auto search = [&]() {
+    std::vector<PrincipalVariation> pv(MAX_SEARCH_DEPTH + 1);
+    for (uint8_t i = next_move++; i < n_moves; i = next_move++) {
+      RootMove &root_move = root_moves[i];
+      GameState child = game_state;
+      applyMove(root_move.move, child);
+      int16_t alpha = n_lines > 1 ? -INT16_MAX : best_score.load();
+      NegamaxTuple result =
+          negamax(child, depth - 1, -color, -INT16_MAX, -alpha, pv.data());
+      root_move.score = -result.score;
+      root_move.exact = root_move.score > alpha || alpha == -INT16_MAX;
+      root_move.pv.moves[0] = root_move.move;
+      std::copy(pv[0].moves, pv[0].moves + pv[0].length,
+                root_move.pv.moves + 1);
+      root_move.pv.length = pv[0].length + 1;
+      nodes += result.nodes_searched;
+
+      int16_t best = best_score.load();
+      while (root_move.score > best &&
+             !best_score.compare_exchange_weak(best, root_move.score)) {
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < std::min<uint32_t>(n_threads, n_moves); i++) {
+    threads.emplace_back(search);
+  }
+  search();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  nodes_searched = nodes + 1;
+
+  // Ties go to the exact score, then to the move ordered first, as in a
+  // sequential search.
+  std::stable_sort(root_moves.begin(), root_moves.end(),
+                   [](const RootMove &a, const RootMove &b) {
+                     return a.score != b.score ? a.score > b.score
+                                               : a.exact && !b.exact;
+                   });
+  return root_moves;
+}
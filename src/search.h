@@ -2,6 +2,10 @@
 
 #include "board.h"
 #include <stdint.h>
+#include <vector>
+
+// Maximum depth of a search, in plies.
+const uint8_t MAX_SEARCH_DEPTH = 64;
 
 struct NegamaxTuple {
   Move move;
@@ -12,14 +16,50 @@ struct NegamaxTuple {
       : move(move), score(score), nodes_searched(nodes_searched) {}
 };
 
+// Line of best moves found by a search, starting from the searched position.
+struct PrincipalVariation {
+  Move moves[MAX_SEARCH_DEPTH];
+  uint8_t length = 0;
+};
+
 /** Negamax algorithm, finds the best possible move for the active player.
  *
  * @param game_state: Game state.
- * @param depth: Depth to search the game tree.
+ * @param depth: Depth to search the game tree, at most MAX_SEARCH_DEPTH.
  * @param color: 1 for white, -1 for black.
  * @param alpha: A/B pruning parameter, leave default.
  * @param beta: A/B pruning parameter, leave default.
+ * @param pv: Optional array of depth + 1 principal variations, used by each
+ * ply of the search. pv[0] is populated with the line of the best move.
  * @return Negamax tuple of the best move and score.
  */
 NegamaxTuple negamax(GameState game_state, uint8_t depth, int8_t color,
-                     int16_t alpha = INT16_MIN, int16_t beta = INT16_MAX);
+                     int16_t alpha = -INT16_MAX, int16_t beta = INT16_MAX,
+                     PrincipalVariation *pv = nullptr);
+
+// Result of searching a root move.
+struct RootMove {
+  Move move;
+  int16_t score = 0;
+  // False if the score is only an upper bound: the move failed to beat the
+  // best score already found by another thread.
+  bool exact = true;
+  PrincipalVariation pv;
+};
+
+/** Searches the root moves on multiple threads, which take the moves in turn.
+ * With 1 line, a move only has to beat the best score found so far, shared by
+ * the threads. With more lines, every move is searched with a full window, so
+ * that all the scores are exact.
+ *
+ * @param game_state: Game state.
+ * @param depth: Depth to search the game tree, from 1 to MAX_SEARCH_DEPTH.
+ * @param n_threads: Number of threads.
+ * @param n_lines: Number of lines, at least 1.
+ * @param nodes_searched: Number of nodes searched, populated by this function.
+ * @return Root moves, best first. Empty if there are no legal moves.
+ */
+std::vector<RootMove> searchRootMoves(const GameState &game_state,
+                                      uint8_t depth, uint32_t n_threads,
+                                      uint8_t n_lines,
+                                      uint64_t &nodes_searched);
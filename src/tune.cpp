@@ -0,0 +1,470 @@
+#include "tune.h"
+#include "board.h"
+#include "constants.h"
+#include "evaluate.h"
+#include "evaluation_parameters.h"
+#include "helper_functions.h"
+#include "packed_position.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Parameter layout: the material value of each piece type, followed by the
+// positional table of each piece type.
+const uint16_t N_PARAMETERS = N_PIECE_TYPES + N_PIECE_TYPES * N_SQUARES;
+
+// A feature is a piece on a square, stored as the index into the positional
+// tables (piece type * 64 + square, from white's perspective). Black pieces
+// have this flag set.
+const uint16_t BLACK_FEATURE = 0x8000;
+
+// Adam optimizer hyperparameters. The learning rate is in centipawns.
+const float LEARNING_RATE = 1.0;
+const float BETA_1 = 0.9;
+const float BETA_2 = 0.999;
+const float EPSILON = 1e-8;
+
+const char *piece_type_names[N_PIECE_TYPES] = {"pawn", "knight", "bishop",
+                                               "rook", "queen",  "king"};
+
+/** Labeled positions, stored compactly as the pieces on the board. The terms
+ * that are not tuned are folded into a single fixed score per position.
+ */
+struct TuningData {
+  // Features of all the positions, flattened.
+  std::vector<uint16_t> features;
+
+  // Index of the first feature of each position, followed by the total.
+  std::vector<uint32_t> feature_offsets = {0};
+
+  // Game result from white's perspective. 1: win, 0.5: draw, 0: loss.
+  std::vector<float> results;
+
+  // Score of the evaluation terms that are not tuned.
+  std::vector<float> fixed_scores;
+
+  uint32_t size(void) const { return results.size(); }
+};
+
+/** Returns the parameters currently used by the evaluation.
+ *
+ * @return Parameter vector.
+ */
+std::vector<float> getInitialParameters(void) {
+  std::vector<float> parameters = {PAWN_VALUE, KNIGHT_VALUE, BISHOP_VALUE,
+                                   ROOK_VALUE, QUEEN_VALUE,  0};
+  const int8_t *tables[N_PIECE_TYPES] = {
+      white_pawn_position_adjustment, white_knight_position_adjustment,
+      white_bishop_position_adjustment, white_rook_position_adjustment,
+      white_queen_position_adjustment, white_king_position_adjustment};
+  for (const int8_t *table : tables) {
+    parameters.insert(parameters.end(), table, table + N_SQUARES);
+  }
+  return parameters;
+}
+
+/** Returns the material/positional score of a position.
+ *
+ * @param features: Features of the position.
+ * @param n_features: Number of features.
+ * @param parameters: Parameter vector.
+ * @return Score value, from white's perspective.
+ */
+float getLinearScore(const uint16_t *features, uint32_t n_features,
+                     const float *parameters) {
+  float score = 0;
+  for (uint32_t i = 0; i < n_features; i++) {
+    uint16_t index = features[i] & ~BLACK_FEATURE;
+    float value =
+        parameters[index / N_SQUARES] + parameters[N_PIECE_TYPES + index];
+    score += features[i] & BLACK_FEATURE ? -value : value;
+  }
+  return score;
+}
+
+/** Appends a labeled position to the tuning data.
+ *
+ * @param game_state: Game state.
+ * @param result: Game result.
+ * @param parameters: Parameters currently used by the evaluation.
+ * @param data: Tuning data.
+ */
+void addPosition(const GameState &game_state, GameResult result,
+                 const std::vector<float> &parameters, TuningData &data) {
+  for (uint8_t color = WHITE; color < N_COLORS; color++) {
+    for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+      uint64_t bb = game_state.pieces[color][piece_type];
+      while (bb) {
+        uint8_t bit = getSetBit(getLowestSetBitValue(bb));
+        data.features.push_back(
+            color == WHITE ? piece_type * N_SQUARES + bit
+                           : (piece_type * N_SQUARES + 63 - bit) |
+                                 BLACK_FEATURE);
+        clearLowestSetBit(bb);
+      }
+    }
+  }
+
+  uint32_t begin = data.feature_offsets.back();
+  uint32_t n_features = data.features.size() - begin;
+  data.feature_offsets.push_back(data.features.size());
+  // Results are 1: black win, 2: draw, 3: white win.
+  data.results.push_back((result - 1) / 2.0f);
+  data.fixed_scores.push_back(
+      evaluatePosition(game_state) -
+      getLinearScore(&data.features[begin], n_features, parameters.data()));
+}
+
+/** Parses a labeled position and appends it to the tuning data.
+ *
+ * @param line: FEN followed by the game result.
+ * @param parameters: Parameters currently used by the evaluation.
+ * @param data: Tuning data.
+ */
+void addPosition(std::string_view line, const std::vector<float> &parameters,
+                 TuningData &data) {
+  size_t fen_length = getFenLength(line);
+  GameResult result = parseGameResult(line.substr(fen_length));
+  GameState game_state;
+  if (!fen_length || result == RESULT_NONE ||
+      fenToGameState(line.substr(0, fen_length), game_state) != FEN_OK) {
+    return;
+  }
+  addPosition(game_state, result, parameters, data);
+}
+
+/** Loads the labeled positions of a text file, parsing the lines in parallel.
+ *
+ * @param data_path: Path to the labeled positions file.
+ * @param parameters: Parameters currently used by the evaluation.
+ * @param chunks: Tuning data per thread, populated by this function.
+ * @return Number of threads used.
+ */
+uint32_t loadTextTuningData(const std::string &data_path,
+                            const std::vector<float> &parameters,
+                            std::vector<TuningData> &chunks) {
+  std::ifstream file(data_path, std::ios::binary);
+  if (!file) {
+    logErrorAndExit("ERROR: Could not open " + data_path + ".");
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string text = buffer.str();
+
+  std::vector<std::pair<size_t, size_t>> lines;
+  for (size_t start = 0; start < text.size();) {
+    size_t end = text.find('\n', start);
+    end = end == std::string::npos ? text.size() : end;
+    lines.push_back({start, end});
+    start = end + 1;
+  }
+
+  return runInParallel(
+      lines.size(), [&](uint32_t thread, uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+          std::string_view line = std::string_view(text).substr(
+              lines[i].first, lines[i].second - lines[i].first);
+          addPosition(line, parameters, chunks[thread]);
+        }
+      });
+}
+
+/** Loads the labeled positions of a packed position file, evaluating the
+ * positions of each batch read in parallel.
+ *
+ * @param data_path: Path to the packed position file.
+ * @param parameters: Parameters currently used by the evaluation.
+ * @param chunks: Tuning data per thread, populated by this function.
+ * @return Number of threads used.
+ */
+uint32_t loadPackedTuningData(const std::string &data_path,
+                              const std::vector<float> &parameters,
+                              std::vector<TuningData> &chunks) {
+  const uint32_t BATCH_SIZE = 1 << 16;
+  PackedPositionReader reader(data_path);
+  if (!reader.isOpen()) {
+    logErrorAndExit("ERROR: Could not open " + data_path + ".");
+  }
+
+  uint32_t n_chunks = 0;
+  std::vector<PositionRecord> records;
+  PositionRecord record;
+  bool more = true;
+  while (more) {
+    records.clear();
+    while (records.size() < BATCH_SIZE && (more = reader.read(record))) {
+      if (record.result != RESULT_NONE) {
+        records.push_back(record);
+      }
+    }
+    n_chunks = std::max(
+        n_chunks,
+        runInParallel(records.size(),
+                      [&](uint32_t thread, uint32_t begin, uint32_t end) {
+                        for (uint32_t i = begin; i < end; i++) {
+                          addPosition(records[i].game_state, records[i].result,
+                                      parameters, chunks[thread]);
+                        }
+                      }));
+  }
+  return n_chunks;
+}
+
+/** Loads the labeled positions, from a text file or a packed position file.
+ *
+ * @param data_path: Path to the labeled positions file.
+ * @param parameters: Parameters currently used by the evaluation.
+ * @return Tuning data.
+ */
+TuningData loadTuningData(const std::string &data_path,
+                          const std::vector<float> &parameters) {
+  std::vector<TuningData> chunks(std::thread::hardware_concurrency() + 1);
+  bool packed = data_path.ends_with(PACKED_POSITION_EXTENSION);
+  uint32_t n_chunks =
+      packed ? loadPackedTuningData(data_path, parameters, chunks)
+             : loadTextTuningData(data_path, parameters, chunks);
+
+  TuningData data;
+  for (uint32_t i = 0; i < n_chunks; i++) {
+    uint32_t offset = data.features.size();
+    data.features.insert(data.features.end(), chunks[i].features.begin(),
+                         chunks[i].features.end());
+    for (uint32_t j = 1; j < chunks[i].feature_offsets.size(); j++) {
+      data.feature_offsets.push_back(offset + chunks[i].feature_offsets[j]);
+    }
+    data.results.insert(data.results.end(), chunks[i].results.begin(),
+                        chunks[i].results.end());
+    data.fixed_scores.insert(data.fixed_scores.end(),
+                             chunks[i].fixed_scores.begin(),
+                             chunks[i].fixed_scores.end());
+  }
+  return data;
+}
+
+/** Computes the sum of the squared errors over a range of positions, and
+ * accumulates the gradient of the error with respect to the parameters.
+ *
+ * @param data: Tuning data.
+ * @param parameters: Parameter vector.
+ * @param k: Scaling constant of the sigmoid.
+ * @param begin: First position.
+ * @param end: Last position (exclusive).
+ * @param gradient: Gradient to accumulate into, or nullptr.
+ * @return Sum of the squared errors.
+ */
+double computeError(const TuningData &data,
+                    const std::vector<float> &parameters, double k,
+                    uint32_t begin, uint32_t end, double *gradient) {
+  // Evaluate. Sparse, so gathered one position at a time.
+  std::vector<float> scores(end - begin);
+  for (uint32_t i = begin; i < end; i++) {
+    scores[i - begin] =
+        data.fixed_scores[i] +
+        getLinearScore(&data.features[data.feature_offsets[i]],
+                       data.feature_offsets[i + 1] - data.feature_offsets[i],
+                       parameters.data());
+  }
+
+  // Error and its derivative with respect to the score. The error sums
+  // millions of terms, so it is accumulated in double precision.
+  const float scale = k * std::log(10.0f) / 400;
+  const float *results = &data.results[begin];
+  float *derivatives = scores.data();
+  double error = 0;
+  for (uint32_t i = 0; i < end - begin; i++) {
+    float sigmoid = 1 / (1 + std::exp(-scale * scores[i]));
+    float difference = results[i] - sigmoid;
+    error += (double)difference * difference;
+    derivatives[i] = -2 * difference * sigmoid * (1 - sigmoid) * scale;
+  }
+
+  if (gradient) {
+    for (uint32_t i = begin; i < end; i++) {
+      for (uint32_t j = data.feature_offsets[i];
+           j < data.feature_offsets[i + 1]; j++) {
+        uint16_t index = data.features[j] & ~BLACK_FEATURE;
+        float derivative = data.features[j] & BLACK_FEATURE
+                               ? -derivatives[i - begin]
+                               : derivatives[i - begin];
+        gradient[index / N_SQUARES] += derivative;
+        gradient[N_PIECE_TYPES + index] += derivative;
+      }
+    }
+  }
+  return error;
+}
+
+/** Computes the mean squared error over all the positions, in parallel.
+ *
+ * @param data: Tuning data.
+ * @param parameters: Parameter vector.
+ * @param k: Scaling constant of the sigmoid.
+ * @param gradient: Mean gradient of the error, if not nullptr.
+ * @return Mean squared error.
+ */
+double computeMeanError(const TuningData &data,
+                        const std::vector<float> &parameters, double k,
+                        std::vector<double> *gradient) {
+  uint32_t max_threads = std::thread::hardware_concurrency() + 1;
+  std::vector<double> errors(max_threads, 0);
+  std::vector<std::vector<double>> gradients(
+      gradient ? max_threads : 0, std::vector<double>(N_PARAMETERS, 0));
+
+  uint32_t n_threads = runInParallel(
+      data.size(), [&](uint32_t thread, uint32_t begin, uint32_t end) {
+        errors[thread] =
+            computeError(data, parameters, k, begin, end,
+                         gradient ? gradients[thread].data() : nullptr);
+      });
+
+  double error = 0;
+  for (uint32_t i = 0; i < n_threads; i++) {
+    error += errors[i];
+  }
+  if (gradient) {
+    gradient->assign(N_PARAMETERS, 0);
+    for (uint32_t i = 0; i < n_threads; i++) {
+      for (uint16_t j = 0; j < N_PARAMETERS; j++) {
+        (*gradient)[j] += gradients[i][j] / data.size();
+      }
+    }
+  }
+  return error / data.size();
+}
+
+/** Finds the sigmoid scaling constant that best fits the current parameters,
+ * with a golden section search.
+ *
+ * @param data: Tuning data.
+ * @param parameters: Parameter vector.
+ * @return Scaling constant.
+ */
+double findScalingConstant(const TuningData &data,
+                           const std::vector<float> &parameters) {
+  const double golden_ratio = (std::sqrt(5.0) - 1) / 2;
+  double low = 0.1, high = 3.0;
+  for (uint8_t i = 0; i < 30; i++) {
+    double k1 = high - golden_ratio * (high - low);
+    double k2 = low + golden_ratio * (high - low);
+    if (computeMeanError(data, parameters, k1, nullptr) <
+        computeMeanError(data, parameters, k2, nullptr)) {
+      high = k2;
+    } else {
+      low = k1;
+    }
+  }
+  return (low + high) / 2;
+}
+
+/** Writes the parameters as an evaluation parameters header. The mean of each
+ * positional table is moved into the material value, which leaves the
+ * evaluation unchanged and keeps the tables within int8_t range.
+ *
+ * @param parameters: Parameter vector.
+ * @param output_path: Path of the generated header file.
+ */
+void writeParametersHeader(std::vector<float> parameters,
+                           const std::string &output_path) {
+  for (uint8_t piece_type = PAWN; piece_type < N_PIECE_TYPES; piece_type++) {
+    float *table = &parameters[N_PIECE_TYPES + piece_type * N_SQUARES];
+    // Pawns never stand on the first/last rank, so ignore those squares.
+    uint8_t first = piece_type == PAWN ? 8 : 0;
+    uint8_t last = piece_type == PAWN ? 56 : N_SQUARES;
+    float mean = 0;
+    for (uint8_t bit = first; bit < last; bit++) {
+      mean += table[bit] / (last - first);
+    }
+    for (uint8_t bit = first; bit < last; bit++) {
+      table[bit] -= mean;
+    }
+    parameters[piece_type] += piece_type == KING ? 0 : mean;
+  }
+
+  std::ofstream file(output_path);
+  file << "#pragma once\n\n"
+       << "// Material values and positional tables used by the evaluation. "
+          "Can be\n"
+       << "// regenerated by the tuner (\"venus_chess tune ...\").\n\n"
+       << "#include \"constants.h\"\n#include <iterator>\n"
+       << "#include <stdint.h>\n\n";
+  const char *value_names[N_PIECE_TYPES - 1] = {
+      "PAWN_VALUE", "KNIGHT_VALUE", "BISHOP_VALUE", "ROOK_VALUE",
+      "QUEEN_VALUE"};
+  for (uint8_t piece_type = PAWN; piece_type < KING; piece_type++) {
+    file << "const int16_t " << value_names[piece_type] << " = "
+         << std::lround(parameters[piece_type]) << ";\n";
+  }
+
+  // Same table order as the hand written header.
+  const PieceType table_order[N_PIECE_TYPES] = {PAWN,   KNIGHT, ROOK,
+                                                BISHOP, QUEEN,  KING};
+  file << "\n// clang-format off\n";
+  for (PieceType piece_type : table_order) {
+    file << "constexpr int8_t white_" << piece_type_names[piece_type]
+         << "_position_adjustment[] = {\n";
+    for (uint8_t bit = 0; bit < N_SQUARES; bit++) {
+      long value =
+          std::clamp(std::lround(parameters[N_PIECE_TYPES +
+                                            piece_type * N_SQUARES + bit]),
+                     (long)INT8_MIN, (long)INT8_MAX);
+      file << (bit % 8 == 0 ? " " : "") << std::setw(4) << value << ","
+           << (bit % 8 == 7 ? "\n" : "");
+    }
+    file << "};\n\n";
+  }
+  file << "// clang-format on\n\n"
+       << "// A missing comma silently merges two entries, so check the table "
+          "sizes.\n";
+  for (PieceType piece_type : table_order) {
+    file << "static_assert(std::size(white_" << piece_type_names[piece_type]
+         << "_position_adjustment) == N_SQUARES);\n";
+  }
+}
+
+void runTuning(const std::string &data_path, uint32_t n_epochs,
+               const std::string &output_path) {
+  auto start = std::chrono::high_resolution_clock::now();
+  auto elapsed = [&start]() {
+    auto now = std::chrono::high_resolution_clock::now();
+    return (double)(now - start).count() / 1000000000;
+  };
+
+  std::vector<float> parameters = getInitialParameters();
+  TuningData data = loadTuningData(data_path, parameters);
+  if (!data.size()) {
+    logErrorAndExit("ERROR: No labeled positions found in " + data_path + ".");
+  }
+  std::cout << "Loaded " << data.size() << " positions in " << elapsed()
+            << " s." << std::endl;
+
+  double k = findScalingConstant(data, parameters);
+  std::cout << "Scaling constant K: " << k << ", initial error: "
+            << computeMeanError(data, parameters, k, nullptr) << std::endl;
+
+  std::vector<double> gradient;
+  std::vector<double> m(N_PARAMETERS, 0), v(N_PARAMETERS, 0);
+  for (uint32_t epoch = 1; epoch <= n_epochs; epoch++) {
+    double error = computeMeanError(data, parameters, k, &gradient);
+    for (uint16_t i = 0; i < N_PARAMETERS; i++) {
+      m[i] = BETA_1 * m[i] + (1 - BETA_1) * gradient[i];
+      v[i] = BETA_2 * v[i] + (1 - BETA_2) * gradient[i] * gradient[i];
+      double m_hat = m[i] / (1 - std::pow(BETA_1, epoch));
+      double v_hat = v[i] / (1 - std::pow(BETA_2, epoch));
+      parameters[i] -= LEARNING_RATE * m_hat / (std::sqrt(v_hat) + EPSILON);
+    }
+    if (epoch % 50 == 0 || epoch == n_epochs) {
+      std::cout << "Epoch " << epoch << ", error: " << error
+                << ", time elapsed: " << elapsed() << " s." << std::endl;
+    }
+  }
+
+  writeParametersHeader(parameters, output_path);
+  std::cout << "Final error: " << computeMeanError(data, parameters, k, nullptr)
+            << ". Parameters written to " << output_path << "." << std::endl;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+/** Tunes the material values and positional tables of the evaluation with
+ * Texel's tuning method, and writes the tuned parameters as a header file that
+ * can replace src/evaluation_parameters.h.
+ *
+ * The data file holds one labeled position per line: a FEN followed by the
+ * game result, either as "1-0", "0-1", "1/2-1/2" (e.g. EPD "c9" opcode) or as
+ * "[1.0]", "[0.5]", "[0.0]". Files ending in PACKED_POSITION_EXTENSION are read
+ * as packed positions instead, skipping those without a result.
+ *
+ * @param data_path: Path to the labeled positions file.
+ * @param n_epochs: Number of gradient descent iterations.
+ * @param output_path: Path of the generated header file.
+ */
+void runTuning(const std::string &data_path, uint32_t n_epochs,
+               const std::string &output_path);
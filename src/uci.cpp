@@ -3,21 +3,16 @@
 #include "helper_functions.h"
 #include "log.h"
 #include "move.h"
+#include "move_generator.h"
 #include "search.h"
+#include "uci.h"
+#include "uci_options.h"
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <unistd.h>
-
-/** Determines if string contains a substring.
- *
- * @param substr: Substring.
- * @param str: String to search.
- * @return True or false.
- */
-bool stringContains(std::string substr, std::string str) {
-  return str.find(substr) != std::string::npos;
-}
+#include <vector>
 
 /** Determines if the move is a special move and assigns the move type
  * accordingly.
@@ -26,7 +21,16 @@ bool stringContains(std::string substr, std::string str) {
  * @param move_str: Move, algebraic notation.
  * @param move: Move, internal notation.
  */
-void checkForAndSetSpecialMoveTypes(const GameState &game_state, const std::string move_str, Move &move) {
+void checkForAndSetSpecialMoveTypes(const GameState &game_state, std::string_view move_str, Move &move) {
+  const Color color = game_state.getActiveColor();
+  const uint64_t *player_pieces = game_state.pieces[color];
+  uint64_t initial_bitboard = move.getInitialBitboard();
+  uint64_t final_bitboard = move.getFinalBitboard();
+
+  // Check for captures, including en passant.
+  move.setCapture((final_bitboard & game_state.occupancy[color ^ 1]) ||
+                  ((initial_bitboard & player_pieces[PAWN]) && (final_bitboard & getEnPassantBitboard(game_state.en_passant))));
+
   // Check for promotion moves.
   if (move_str.size() == 5) {
     if (move_str[4] == 'q') {
@@ -41,12 +45,8 @@ void checkForAndSetSpecialMoveTypes(const GameState &game_state, const std::stri
     return;
   }
 
-  ColorState player_state = game_state.whites_turn ? game_state.white : game_state.black;
-  uint64_t initial_bitboard = move.getInitialBitboard();
-  uint64_t final_bitboard = move.getFinalBitboard();
-
   // Check for castle moves.
-  if (initial_bitboard & player_state.king) {
+  if (initial_bitboard & player_pieces[KING]) {
     if (final_bitboard & (initial_bitboard << 2)) {
       move.setMoveType(CASTLE_KINGSIDE);
       return;
@@ -57,9 +57,9 @@ void checkForAndSetSpecialMoveTypes(const GameState &game_state, const std::stri
   }
 
   // Check for pawn push 2 moves.
-  if ((initial_bitboard & player_state.pawn) &&
+  if ((initial_bitboard & player_pieces[PAWN]) &&
       (final_bitboard &
-       (game_state.whites_turn ? player_state.pawn << 16 : player_state.pawn >> 16))) {
+       (game_state.side_to_move == WHITE ? initial_bitboard << 16 : initial_bitboard >> 16))) {
     move.setMoveType(PAWN_PUSH_2);
   }
 }
@@ -70,118 +70,216 @@ void checkForAndSetSpecialMoveTypes(const GameState &game_state, const std::stri
  * @param game_state: Game state.
  * @return Move, internal notation.
  */
-Move algebraicMoveToInternalMove(std::string move_str, const GameState &game_state) {
-  uint8_t y1 = move_str[0] - 'a';
-  uint8_t x1 = move_str[1] - '1';
-  uint8_t y2 = move_str[2] - 'a';
-  uint8_t x2 = move_str[3] - '1';
-  Move move = Move(x1, y1, x2, y2);
+Move algebraicMoveToInternalMove(std::string_view move_str, const GameState &game_state) {
+  uint8_t from = (move_str[1] - '1') * 8 + move_str[0] - 'a';
+  uint8_t to = (move_str[3] - '1') * 8 + move_str[2] - 'a';
+  Move move = Move(from, to);
   checkForAndSetSpecialMoveTypes(game_state, move_str, move);
   return move;
 }
 
-/** Extract the moves from the UCI format and applies them to the game state.
+/** Applies the moves in UCI format to the game state. Stops at the first
+ * malformed or illegal move instead of corrupting the game state.
  *
- * @param input: String of algebraic moves.
+ * @param moves: Space separated algebraic moves.
  * @param game_state: Game state.
+ * @return Length of the prefix of moves that was applied.
  */
-void extractAndApplyMoves(std::string input, GameState &game_state) {
-  uint8_t n_moves = 0;
-  uint8_t start_pos = input.find("moves") + 6;
-  input = input.substr(start_pos, input.size() - start_pos) + " ";
-  while (stringContains(" ", input)) {
-    uint8_t space_pos = input.find(" ") + 1;
-    std::string move_str = input.substr(0, space_pos - 1);
-    input = input.substr(space_pos, input.size() - space_pos);
-    applyMove(algebraicMoveToInternalMove(move_str, game_state), game_state);
+size_t applyMoves(std::string_view moves, GameState &game_state) {
+  size_t pos = 0;
+  size_t applied = 0;
+  for (std::string_view move_str = getNextToken(moves, pos); !move_str.empty();
+       move_str = getNextToken(moves, pos)) {
+    if (move_str.size() < 4 || move_str.size() > 5 || move_str[0] < 'a' ||
+        move_str[0] > 'h' || move_str[1] < '1' || move_str[1] > '8' ||
+        move_str[2] < 'a' || move_str[2] > 'h' || move_str[3] < '1' ||
+        move_str[3] > '8') {
+      printAndWriteToLog("info string illegal move " + std::string(move_str), LOG_ERROR);
+      break;
+    }
+    Move move = algebraicMoveToInternalMove(move_str, game_state);
+    if (!isLegal(game_state, move)) {
+      printAndWriteToLog("info string illegal move " + std::string(move_str), LOG_ERROR);
+      break;
+    }
+    applyMove(move, game_state);
+    applied = pos;
   }
+  return applied;
 }
 
 /** Handles the UCI input of "uci".
+ *
+ * @param options: Engine options.
  */
-void handleInput_uci(void) {
+void handleInput_uci(const UCIOptions &options) {
   printAndWriteToLog("id name venus");
   printAndWriteToLog("id author David Doellstedt");
+  for (const std::string &declaration : options.getDeclarations()) {
+    printAndWriteToLog(declaration);
+  }
   printAndWriteToLog("uciok");
 }
 
+/** Handles the UCI input of "setoption name <name> [value <value>]". The
+ * search runs on the input thread, so options only change between searches:
+ * the logging options apply immediately, the search options on the next "go".
+ *
+ * @param input: UCI text input.
+ * @param options: Engine options.
+ */
+void handleInput_setoption(std::string_view input, UCIOptions &options) {
+  size_t pos = 0;
+  getNextToken(input, pos);
+  if (getNextToken(input, pos) != "name") {
+    printAndWriteToLog("info string missing option name", LOG_ERROR);
+    return;
+  }
+  // Names and values may contain spaces.
+  std::string name;
+  std::string_view value;
+  for (std::string_view token = getNextToken(input, pos); !token.empty(); token = getNextToken(input, pos)) {
+    if (token == "value") {
+      value = input.substr(pos);
+      size_t begin = value.find_first_not_of(" \t");
+      value = begin == std::string_view::npos ? "" : value.substr(begin, value.find_last_not_of(" \t\r\n") + 1 - begin);
+      break;
+    }
+    name += (name.empty() ? "" : " ") + std::string(token);
+  }
+  if (!options.set(name, value)) {
+    printAndWriteToLog("info string invalid option " + name + " value " + std::string(value), LOG_ERROR);
+    return;
+  }
+
+  const std::string &level = options.getString("Log Level");
+  setLogFile(options.getString("Log File"));
+  setLogLevel(level == "Error" ? LOG_ERROR : level == "Info" ? LOG_INFO : level == "Debug" ? LOG_DEBUG : LOG_OFF);
+}
+
 /** Handles the UCI input of "is_ready".
  */
 void handleInput_isready(void) { printAndWriteToLog("readyok"); }
 
-/** Handles the UCI input of "position fen ... moves ...".
+/** Handles the UCI input of "position [startpos | fen ...] moves ...". If the
+ * base position is unchanged and the moves extend the previous ones, only the
+ * new moves are applied.
  *
  * @param input: UCI text input.
- * @param game_state: Game state.
+ * @param position: Position of the UCI session.
  */
-void handleInput_position(std::string input, GameState &game_state) {
-    memset(&game_state, 0, sizeof(GameState));
-  std::string fen = fen_standard;
-  bool has_moves = stringContains("moves", input);
-
-  if (stringContains("fen", input)) {
-    uint8_t start_pos = input.find("fen") + 4;
-    uint16_t end_pos = has_moves ? input.find("moves") - 2 : input.size();
-    fen = input.substr(start_pos, end_pos - start_pos);
+void handleInput_position(std::string_view input, UCIPosition &position) {
+  size_t pos = 0;
+  getNextToken(input, pos);
+  std::string_view token = getNextToken(input, pos);
+  std::string_view fen = fen_standard;
+  if (token == "fen") {
+    size_t fen_begin = pos;
+    size_t fen_end = pos;
+    while (!(token = getNextToken(input, pos)).empty() && token != "moves") {
+      fen_end = pos;
+    }
+    fen = input.substr(fen_begin, fen_end - fen_begin);
+  } else if (token == "startpos") {
+    token = getNextToken(input, pos);
+  }
+  std::string_view moves = token == "moves" ? input.substr(pos) : "";
+  // Compare the moves as text from their first character on.
+  while (!moves.empty() && moves.front() == ' ') {
+    moves.remove_prefix(1);
   }
-  fenToGameState(fen, game_state);
 
-  if (has_moves) {
-    extractAndApplyMoves(input, game_state);
+  const std::string &applied = position.moves;
+  bool extends = !position.fen.empty() && fen == position.fen &&
+                 moves.starts_with(applied) &&
+                 (applied.empty() || moves.size() == applied.size() ||
+                  moves[applied.size()] == ' ');
+  if (!extends) {
+    FenError error = fenToGameState(fen, position.game_state);
+    if (error != FEN_OK) {
+      printAndWriteToLog(std::string("info string invalid fen: ") + fenErrorToString(error), LOG_ERROR);
+      fenToGameState(fen_standard, position.game_state);
+      position.fen = fen_standard;
+      position.moves.clear();
+      return;
+    }
+    position.fen = fen;
+    position.moves.clear();
   }
+
+  size_t begin = position.moves.size();
+  size_t n_applied = applyMoves(moves.substr(begin), position.game_state);
+  position.moves = moves.substr(0, begin + n_applied);
 }
 
-/** Handles the UCI input of "go ...".
+/** Handles the UCI input of "go ...". Searches on the number of threads of the
+ * Threads option, and prints as many lines as the MultiPV option.
  *
  * @param input: UCI text input.
  * @param game_state: Game state.
+ * @param options: Engine options.
  */
-void handleInput_go(std::string input, const GameState &game_state) {
-  NegamaxTuple choice = negamax(game_state, 5, game_state.whites_turn ? 1 : -1);
-  printAndWriteToLog("info score cp " + std::to_string(choice.score) + " pv " +
-                     choice.move.toString());
-  printAndWriteToLog("bestmove " + choice.move.toString());
+void handleInput_go(std::string input, const GameState &game_state, const UCIOptions &options) {
+  const uint8_t depth = 5;
+  const uint8_t n_lines = options.getSpin("MultiPV");
+  uint64_t nodes;
+  std::vector<RootMove> root_moves = searchRootMoves(game_state, depth, options.getSpin("Threads"), n_lines, nodes);
+  if (root_moves.empty()) {
+    printAndWriteToLog("bestmove 0000");
+    return;
+  }
+  for (uint8_t i = 0; i < n_lines && i < root_moves.size(); i++) {
+    std::string pv_moves;
+    for (uint8_t j = 0; j < root_moves[i].pv.length; j++) {
+      pv_moves += " " + root_moves[i].pv.moves[j].toString();
+    }
+    printAndWriteToLog("info depth " + std::to_string(depth) + " multipv " + std::to_string(i + 1) + " score cp " +
+                       std::to_string(root_moves[i].score) + " nodes " + std::to_string(nodes) + " pv" + pv_moves);
+  }
+  printAndWriteToLog("bestmove " + root_moves[0].move.toString());
 }
 
-/** Handles all UCI input to the chess engine.
- *
- * @param input: UCI text input.
- * @param game_state: Game state.
- */
-void UCIHandleInput(std::string input, GameState &game_state) {
-  if (input == "quit") {
+void UCIHandleInput(std::string_view input, UCIPosition &position, UCIOptions &options) {
+  size_t pos = 0;
+  std::string_view command = getNextToken(input, pos);
+  if (command == "quit") {
+    flushOutput();
+    stopLogger();
     exit(1);
-  } else if (input == "uci") {
-    handleInput_uci();
-  } else if (input == "isready") {
+  } else if (command == "uci") {
+    handleInput_uci(options);
+  } else if (command == "isready") {
     handleInput_isready();
-  } else if (stringContains("position", input)) {
-    handleInput_position(input, game_state);
-  } else if (stringContains("go", input)) {
-    handleInput_go(input, game_state);
-  } else if (input == "stop") {
+  } else if (command == "ucinewgame") {
+    position = UCIPosition();
+    fenToGameState(fen_standard, position.game_state);
+  } else if (command == "setoption") {
+    handleInput_setoption(input, options);
+  } else if (command == "position") {
+    handleInput_position(input, position);
+  } else if (command == "go") {
+    handleInput_go(std::string(input), position.game_state, options);
+  } else if (command == "stop") {
     // do nothing.
   } else {
-    //printAndWriteToLog("command :'" + input + "' not supported/recognized.");
+    writeToLog("command '" + std::string(input) + "' not supported/recognized.", LOG_DEBUG);
   }
 }
 
 void UCIStart(void) {
-  std::ofstream file(fp_log);
-
   std::string input;
-  GameState game_state;
-
-  while (1) {
-    getline(std::cin, input);
+  UCIPosition position;
+  UCIOptions options;
+  fenToGameState(fen_standard, position.game_state);
 
+  while (std::getline(std::cin, input)) {
     if (input.size() > 0) {
-      std::ofstream outfile;
-      outfile.open(fp_log, std::ios_base::app);
-      outfile << ">> " << input << "\n";
-      outfile.close();
+      writeToLog(">> " + input, LOG_INFO);
     }
 
-    UCIHandleInput(input, game_state);
+    // Output is buffered, and flushed once the reply to the command is
+    // complete.
+    UCIHandleInput(input, position, options);
+    flushOutput();
   }
 }
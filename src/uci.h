@@ -1,5 +1,31 @@
 #pragma once
 
+#include "board.h"
+#include "uci_options.h"
+#include <string>
+#include <string_view>
+
+// Position of the UCI session. The moves of the last "position" command are
+// kept, so that a command extending them only applies the new moves.
+struct UCIPosition {
+  GameState game_state;
+
+  // FEN of the base position, empty until the first "position" command.
+  std::string fen;
+
+  // Moves applied to the base position, as sent by the GUI.
+  std::string moves;
+};
+
+/** Handles all UCI input to the chess engine.
+ *
+ * @param input: UCI text input.
+ * @param position: Position of the UCI session.
+ * @param options: Engine options, kept across games.
+ */
+void UCIHandleInput(std::string_view input, UCIPosition &position,
+                    UCIOptions &options);
+
 /** Starts a UCI session. Could be with a GUI or a CLI.
  */
-void UCIStart(void);
\ No newline at end of file
+void UCIStart(void);
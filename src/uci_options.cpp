@@ -0,0 +1,120 @@
+#include "uci_options.h"
+#include "constants.h"
+#include "helper_functions.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string>
+
+/** Returns true if the strings are equal, ignoring case.
+ *
+ * @param a: String.
+ * @param b: String.
+ * @return True if equal.
+ */
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+    return std::tolower((unsigned char)x) == std::tolower((unsigned char)y);
+  });
+}
+
+UCIOptions::UCIOptions() {
+  options = {
+      {"Threads", OPTION_SPIN, "1", 1, 256},
+      {"Hash", OPTION_SPIN, "16", 1, 65536},
+      {"Move Overhead", OPTION_SPIN, "10", 0, 5000},
+      {"MultiPV", OPTION_SPIN, "1", 1, MAX_POSSIBLE_MOVES_PER_POSITION},
+      {"Ponder", OPTION_CHECK, "false"},
+      {"Log Level",
+       OPTION_COMBO,
+       "Off",
+       0,
+       0,
+       {"Off", "Error", "Info", "Debug"}},
+      {"Log File", OPTION_STRING, "venus.log"}};
+}
+
+std::vector<std::string> UCIOptions::getDeclarations(void) const {
+  const char *type_names[] = {"check", "spin", "combo", "string"};
+  std::vector<std::string> declarations;
+  for (const UCIOption &option : options) {
+    std::string declaration = "option name " + option.name + " type " +
+                              type_names[option.type] + " default " +
+                              (option.default_value.empty()
+                                   ? "<empty>"
+                                   : option.default_value);
+    if (option.type == OPTION_SPIN) {
+      declaration += " min " + std::to_string(option.min) + " max " +
+                     std::to_string(option.max);
+    }
+    for (const std::string &combo_value : option.combo_values) {
+      declaration += " var " + combo_value;
+    }
+    declarations.push_back(declaration);
+  }
+  return declarations;
+}
+
+bool UCIOptions::set(std::string_view name, std::string_view value) {
+  size_t index = find(name);
+  if (index == options.size()) {
+    return false;
+  }
+  UCIOption *option = &options[index];
+  switch (option->type) {
+  case OPTION_CHECK:
+    if (!equalsIgnoreCase(value, "true") && !equalsIgnoreCase(value, "false")) {
+      return false;
+    }
+    option->value = equalsIgnoreCase(value, "true") ? "true" : "false";
+    return true;
+  case OPTION_SPIN: {
+    int64_t spin;
+    auto [end, error] =
+        std::from_chars(value.data(), value.data() + value.size(), spin);
+    if (error != std::errc() || end != value.data() + value.size() ||
+        spin < option->min || spin > option->max) {
+      return false;
+    }
+    option->value = std::to_string(spin);
+    return true;
+  }
+  case OPTION_COMBO:
+    for (const std::string &combo_value : option->combo_values) {
+      if (equalsIgnoreCase(value, combo_value)) {
+        option->value = combo_value;
+        return true;
+      }
+    }
+    return false;
+  case OPTION_STRING:
+    option->value = value == "<empty>" ? "" : value;
+    return true;
+  }
+  return false;
+}
+
+int64_t UCIOptions::getSpin(std::string_view name) const {
+  return std::stoll(getString(name));
+}
+
+bool UCIOptions::getCheck(std::string_view name) const {
+  return getString(name) == "true";
+}
+
+const std::string &UCIOptions::getString(std::string_view name) const {
+  size_t index = find(name);
+  if (index == options.size()) {
+    logErrorAndExit("ERROR: Unknown option " + std::string(name) + ".");
+  }
+  return options[index].value;
+}
+
+size_t UCIOptions::find(std::string_view name) const {
+  size_t index = 0;
+  while (index < options.size() &&
+         !equalsIgnoreCase(options[index].name, name)) {
+    index++;
+  }
+  return index;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum UCIOptionType : uint8_t {
+  OPTION_CHECK = 0,
+  OPTION_SPIN = 1,
+  OPTION_COMBO = 2,
+  OPTION_STRING = 3
+};
+
+// Engine option that the GUI can set with "setoption".
+struct UCIOption {
+  /** Creates an option, set to its default value.
+   *
+   * @param name: Option name.
+   * @param type: Option type.
+   * @param default_value: Default value, as text.
+   * @param min: Minimum value of a spin option.
+   * @param max: Maximum value of a spin option.
+   * @param combo_values: Values of a combo option.
+   */
+  UCIOption(std::string name, UCIOptionType type, std::string default_value,
+            int64_t min = 0, int64_t max = 0,
+            std::vector<std::string> combo_values = {})
+      : name(std::move(name)), type(type),
+        default_value(std::move(default_value)), min(min), max(max),
+        combo_values(std::move(combo_values)), value(this->default_value) {}
+
+  std::string name;
+  UCIOptionType type;
+  std::string default_value;
+  // Range of a spin option.
+  int64_t min;
+  int64_t max;
+  // Values of a combo option.
+  std::vector<std::string> combo_values;
+  // Current value, as text.
+  std::string value;
+};
+
+/** Registry of the engine options, with their current values. */
+class UCIOptions {
+public:
+  /** Registers the engine options, set to their default values. */
+  UCIOptions();
+
+  /** Returns the "option ..." declaration of each option, sent in reply to
+   * "uci".
+   */
+  std::vector<std::string> getDeclarations(void) const;
+
+  /** Sets an option. Names are case insensitive. Spin values must be in range,
+   * check values "true" or "false", and combo values one of the values.
+   *
+   * @param name: Option name.
+   * @param value: Option value.
+   * @return False if the option is unknown or the value is invalid, in which
+   * case the option keeps its value.
+   */
+  bool set(std::string_view name, std::string_view value);
+
+  /** Returns the value of a spin option. */
+  int64_t getSpin(std::string_view name) const;
+
+  /** Returns the value of a check option. */
+  bool getCheck(std::string_view name) const;
+
+  /** Returns the value of a combo or string option. */
+  const std::string &getString(std::string_view name) const;
+
+private:
+  /** Returns the index of the option with the name, ignoring case.
+   *
+   * @param name: Option name.
+   * @return Index, or the number of options if there is none.
+   */
+  size_t find(std::string_view name) const;
+
+  std::vector<UCIOption> options;
+};
@@ -1,14 +1,27 @@
+#include "../src/analysis.h"
 #include "../src/board.h"
 #include "../src/constants.h"
+#include "../src/epd.h"
+#include "../src/log.h"
 #include "../src/move_generator.h"
+#include "../src/packed_position.h"
+#include "../src/perft.h"
+#include "../src/search.h"
+#include "../src/uci.h"
+#include "../src/uci_options.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <stdint.h>
 #include <string>
+#include <thread>
 
 struct PerftTuple {
   std::string fen = "";
   int depth = 0;
-  int nodes = 0;
+  uint64_t nodes = 0;
 };
 
 // https://www.chessprogramming.org/Perft_Results.
@@ -22,46 +35,31 @@ PerftTuple perft_tests[6] = {
     {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
     {"rk6/1P6/4q3/8/1Q6/8/4p3/4K3 w - - 0 1", 4, 382695}};
 
-/** Runs the perft test to check accuracy of the move generator.
+/** Runs all the perft tests with the current slider backend, and prints the
+ * NPS.
  *
- * @param nodes: Stores the total number of nodes explored.
- * @param game_state: Game state.
- * @param depth: Depth to test to.
- * @param orig_depth: Depth to test to. Used for printing status.
- * @param total: Flag to denote if the search is for total nodes, or nodes per
- * move at depth 1.
+ * @param hash_table: Optional perft hash table.
+ * @param n_threads: Number of threads.
  */
-void perft(uint32_t &nodes, GameState &game_state, uint8_t depth,
-           uint8_t orig_depth, bool total) {
-  bool check = false;
-  Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
-  uint8_t n_moves = generateMoves(game_state, moves, check);
-
-  if (depth == 1) {
-    nodes += n_moves;
-  }
-
-  if (depth > 1) {
-    for (uint8_t i = 0; i < n_moves; i++) {
-      GameState game_state_temp;
-      memcpy(&game_state_temp, &game_state, sizeof(GameState));
-      applyMove(moves[i], game_state_temp);
-
-      perft(nodes, game_state_temp, uint8_t(depth - 1), orig_depth, total);
-    }
-  }
-}
-
-void testAllPerft(void) {
+void runPerftTests(PerftHashTable *hash_table = nullptr,
+                   uint32_t n_threads = 1) {
   auto start = std::chrono::high_resolution_clock::now();
-  int total_nodes = 0;
+  uint64_t total_nodes = 0;
   int i = 0;
 
   for (PerftTuple test : perft_tests) {
-    uint32_t nodes_explored = 0;
     GameState game_state;
     fenToGameState(test.fen, game_state);
-    perft(nodes_explored, game_state, test.depth, test.depth, true);
+    uint64_t nodes_explored = 0;
+    if (n_threads > 1) {
+      Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+      for (uint64_t nodes : parallelPerft(game_state, test.depth, n_threads,
+                                          moves, hash_table)) {
+        nodes_explored += nodes;
+      }
+    } else {
+      nodes_explored = perft(game_state, test.depth, hash_table);
+    }
     total_nodes += nodes_explored;
 
     if (nodes_explored != test.nodes) {
@@ -83,3 +81,579 @@ void testAllPerft(void) {
             << std::endl;
   return;
 }
+
+void testAllPerft(void) {
+  const SliderBackend backends[] = {MAGIC_BACKEND, PEXT_BACKEND};
+  const std::string backend_names[] = {"magic", "PEXT"};
+  SliderBackend default_backend = getSliderBackend();
+
+  for (SliderBackend backend : backends) {
+    if (!setSliderBackend(backend)) {
+      std::cout << "Slider backend: " << backend_names[backend]
+                << " (not supported by this CPU, skipped)." << std::endl;
+      continue;
+    }
+    std::cout << "Slider backend: " << backend_names[backend] << "."
+              << std::endl;
+    runPerftTests();
+  }
+  setSliderBackend(default_backend);
+
+  std::cout << "Perft hash table." << std::endl;
+  PerftHashTable hash_table(16);
+  runPerftTests(&hash_table);
+
+  // Also stress tests the thread safety of the move generator.
+  uint32_t n_threads = std::max(4u, std::thread::hardware_concurrency());
+  std::cout << "Parallel perft, " << n_threads << " threads." << std::endl;
+  runPerftTests(nullptr, n_threads);
+  std::cout << "Parallel perft, shared perft hash table." << std::endl;
+  PerftHashTable shared_hash_table(16);
+  runPerftTests(&shared_hash_table, n_threads);
+}
+
+/** Checks that countMoves() matches the number of generated moves, that
+ * isLegal() accepts exactly the generated moves of the position, out of all
+ * the possible move encodings, that givesCheck() matches the checkers of the
+ * position after each move, and that applyMove() keeps the occupancy and the
+ * mailbox board in sync with the piece bitboards.
+ *
+ * @param game_state: Game state.
+ * @return True if the validation matches the move generator.
+ */
+bool validateAllMoves(GameState game_state) {
+  bool check;
+  Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+  uint8_t n_moves = generateMoves(game_state, moves, check);
+  if (countMoves(game_state) != n_moves) {
+    std::cout << "Move count failed! Expected: " << (int)n_moves
+              << ", but got: " << (int)countMoves(game_state) << std::endl;
+    return false;
+  }
+  for (uint8_t from = 0; from < N_SQUARES; from++) {
+    for (uint8_t to = 0; to < N_SQUARES; to++) {
+      for (uint8_t type = NONE; type <= PAWN_PUSH_2; type++) {
+        for (bool capture : {false, true}) {
+          Move move = Move(from, to, (MoveType)type, capture);
+          bool generated = std::find(moves, moves + n_moves, move) !=
+                           moves + n_moves;
+          if (isLegal(game_state, move) != generated) {
+            std::cout << "Move validation failed! Move: " << move.toString()
+                      << ", generated: " << generated << std::endl;
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  CheckInfo check_info;
+  computeCheckInfo(game_state, check_info);
+  for (uint8_t i = 0; i < n_moves; i++) {
+    GameState child = game_state;
+    applyMove(moves[i], child);
+    if (givesCheck(game_state, check_info, moves[i]) != bool(child.checkers)) {
+      std::cout << "Gives check failed! Move: " << moves[i].toString()
+                << std::endl;
+      return false;
+    }
+    GameState expected = child;
+    populateBoard(expected);
+    if (!std::equal(child.board, child.board + N_SQUARES, expected.board) ||
+        !std::equal(child.occupancy, child.occupancy + N_COLORS,
+                    expected.occupancy) ||
+        child.occupied != expected.occupied) {
+      std::cout << "Board sync failed! Move: " << moves[i].toString()
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+void testMoveValidation(void) {
+  uint32_t n_positions = 0;
+  for (PerftTuple test : perft_tests) {
+    GameState game_state;
+    fenToGameState(test.fen, game_state);
+    bool check;
+    Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+    uint8_t n_moves = generateMoves(game_state, moves, check);
+    bool success = validateAllMoves(game_state);
+    for (uint8_t i = 0; success && i < n_moves; i++) {
+      GameState child = game_state;
+      applyMove(moves[i], child);
+      success = validateAllMoves(child);
+      n_positions++;
+    }
+    if (!success) {
+      std::cout << "Move validation failed for: " << test.fen << std::endl;
+      return;
+    }
+    n_positions++;
+  }
+  std::cout << "Move validation has succeeded! Positions: " << n_positions
+            << "." << std::endl;
+}
+
+struct FenTuple {
+  std::string fen = "";
+  FenError error = FEN_OK;
+};
+
+FenTuple fen_tests[] = {
+    {fen_standard, FEN_OK},
+    {"  4k3/8/8/8/8/8/8/4K3 b - -  ", FEN_OK},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 99 120", FEN_OK},
+    {"", FEN_MISSING_FIELD},
+    {"4k3/8/8/8/8/8/8/4K3 w", FEN_MISSING_FIELD},
+    {"4k3/8/8/8/8/8/8/4K3 w -", FEN_MISSING_FIELD},
+    {"4k3/8/8/8/8/8/8/4K2 w - -", FEN_INVALID_BOARD},
+    {"4k3/8/8/8/8/8/8/4K4 w - -", FEN_INVALID_BOARD},
+    {"4k3/8/8/8/8/8/8/8/4K3 w - -", FEN_INVALID_BOARD},
+    {"4k3/8/8/8/8/8/8 w - -", FEN_INVALID_BOARD},
+    {"4k3/8/8/8/8/8/8/4X3 w - -", FEN_INVALID_BOARD},
+    {"P3k3/8/8/8/8/8/8/4K3 w - -", FEN_INVALID_BOARD},
+    {"4k3/8/8/8/8/8/8/8 w - -", FEN_INVALID_PIECE_COUNT},
+    {"4k3/pppppppp/8/8/8/8/8/qqK5 w - -", FEN_INVALID_PIECE_COUNT},
+    {"4k3/8/8/8/8/8/8/4K3 x - -", FEN_INVALID_SIDE_TO_MOVE},
+    {"4k3/8/8/8/8/8/8/4K3 w KX -", FEN_INVALID_CASTLING},
+    {"4k3/8/8/8/8/8/8/4K3 w KK -", FEN_INVALID_CASTLING},
+    {"4k3/8/8/8/8/8/8/4K3 w - e3", FEN_INVALID_EN_PASSANT},
+    {"4k3/8/8/8/8/8/8/4K3 w - i6", FEN_INVALID_EN_PASSANT},
+    {"4k3/8/8/3Pp3/8/8/8/4K3 w - e6 0 1", FEN_OK},
+    {"4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1", FEN_OK},
+    {"4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1", FEN_INVALID_EN_PASSANT},
+    {"4k3/4p3/8/3Pp3/8/8/8/4K3 w - e6 0 1", FEN_INVALID_EN_PASSANT},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0", FEN_INVALID_MOVE_COUNTER},
+    {"4k3/8/8/8/8/8/8/4K3 w - - x 1", FEN_INVALID_MOVE_COUNTER},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0 70000", FEN_INVALID_MOVE_COUNTER},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0 1 moves", FEN_TRAILING_INPUT}};
+
+void testFenParsing(void) {
+  for (const FenTuple &test : fen_tests) {
+    GameState game_state;
+    FenError error = fenToGameState(test.fen, game_state);
+    if (error != test.error) {
+      std::cout << "FEN parsing failed for: \"" << test.fen
+                << "\". Expected: " << fenErrorToString(test.error)
+                << ", but got: " << fenErrorToString(error) << std::endl;
+      return;
+    }
+  }
+
+  // Castling rights without the rook on its starting square are dropped, and
+  // the move counters are kept up to date by applyMove().
+  GameState game_state;
+  fenToGameState("r3k3/8/8/8/8/8/8/4K2R b KQq - 7 30", game_state);
+  applyMove(Move(60, 59), game_state);
+  if (game_state.castling_rights != WHITE_KING_SIDE ||
+      game_state.halfmove_clock != 8 || game_state.fullmove_number != 31) {
+    std::cout << "FEN parsing failed for the castling rights or the move "
+                 "counters."
+              << std::endl;
+    return;
+  }
+  // Only the active player's pieces are pinned, not a lone enemy piece between
+  // an enemy slider and the king.
+  fenToGameState("4k3/4r3/8/b7/4n3/2N5/8/4K3 w - -", game_state);
+  if (game_state.pinned != 1ULL << 18) {
+    std::cout << "FEN parsing failed for the pinned pieces." << std::endl;
+    return;
+  }
+  std::cout << "FEN parsing has succeeded! FENs: " << std::size(fen_tests)
+            << "." << std::endl;
+}
+
+/** Checks that two position records hold the same position and annotations.
+ *
+ * @param expected: Expected position record.
+ * @param actual: Actual position record.
+ * @return True if the records match.
+ */
+bool isSamePositionRecord(const PositionRecord &expected,
+                          const PositionRecord &actual) {
+  const GameState &a = expected.game_state;
+  const GameState &b = actual.game_state;
+  return getPositionHash(a) == getPositionHash(b) &&
+         std::equal(a.board, a.board + N_SQUARES, b.board) &&
+         a.occupied == b.occupied && a.checkers == b.checkers &&
+         a.pinned == b.pinned && a.halfmove_clock == b.halfmove_clock &&
+         a.fullmove_number == b.fullmove_number &&
+         expected.result == actual.result && expected.score == actual.score &&
+         expected.move == actual.move;
+}
+
+void testPackedPositions(void) {
+  const std::string path = "packed_position_test" + PACKED_POSITION_EXTENSION;
+  std::vector<PositionRecord> records;
+  for (PerftTuple test : perft_tests) {
+    PositionRecord record;
+    fenToGameState(test.fen, record.game_state);
+    bool check;
+    Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+    uint8_t n_moves = generateMoves(record.game_state, moves, check);
+    for (uint8_t i = 0; i < n_moves; i++) {
+      PositionRecord child = record;
+      applyMove(moves[i], child.game_state);
+      child.result = GameResult(i % 4);
+      child.score = i % 2 ? NO_SCORE : -i;
+      child.move = moves[i];
+      records.push_back(child);
+    }
+    records.push_back(record);
+  }
+
+  {
+    PackedPositionWriter writer(path);
+    for (const PositionRecord &record : records) {
+      PackedPosition packed;
+      PositionRecord unpacked;
+      if (!packPosition(record, packed) || !unpackPosition(packed, unpacked) ||
+          !isSamePositionRecord(record, unpacked)) {
+        std::cout << "Packed position failed! Move: "
+                  << record.move.toString() << std::endl;
+        return;
+      }
+      writer.write(record);
+    }
+  }
+
+  // A corrupt record without kings is rejected: only the a1 rook is kept.
+  PositionRecord unpacked;
+  PackedPosition corrupt;
+  fenToGameState(fen_standard, unpacked.game_state);
+  packPosition(unpacked, corrupt);
+  corrupt.occupied = 1;
+  if (unpackPosition(corrupt, unpacked)) {
+    std::cout << "Packed position failed to reject a record without kings."
+              << std::endl;
+    std::remove(path.c_str());
+    return;
+  }
+
+  // A corrupt castling right without its rook is dropped, so no castle move
+  // is generated, and a corrupt en passant square is rejected.
+  fenToGameState("4k3/8/8/8/8/8/8/4K3 w - -", unpacked.game_state);
+  packPosition(unpacked, corrupt);
+  corrupt.state |= WHITE_KING_SIDE << 1;
+  bool check;
+  Move moves[MAX_POSSIBLE_MOVES_PER_POSITION];
+  if (!unpackPosition(corrupt, unpacked) ||
+      unpacked.game_state.castling_rights != NO_CASTLING ||
+      generateMoves(unpacked.game_state, moves, check) != 5) {
+    std::cout << "Packed position failed to drop a corrupt castling right."
+              << std::endl;
+    std::remove(path.c_str());
+    return;
+  }
+  corrupt.state |= 1 << 5 | 4 << 6;
+  if (unpackPosition(corrupt, unpacked)) {
+    std::cout << "Packed position failed to reject a corrupt en passant square."
+              << std::endl;
+    std::remove(path.c_str());
+    return;
+  }
+
+  PackedPositionReader reader(path);
+  PositionRecord record;
+  uint32_t n_read = 0;
+  while (reader.read(record)) {
+    if (n_read >= records.size() ||
+        !isSamePositionRecord(records[n_read], record)) {
+      std::cout << "Packed position file failed at record: " << n_read
+                << std::endl;
+      std::remove(path.c_str());
+      return;
+    }
+    n_read++;
+  }
+  std::remove(path.c_str());
+  if (n_read != records.size()) {
+    std::cout << "Packed position file failed! Expected: " << records.size()
+              << " records, but got: " << n_read << std::endl;
+    return;
+  }
+  std::cout << "Packed positions have succeeded! Positions: " << n_read << "."
+            << std::endl;
+}
+
+void testEpdLoading(void) {
+  const std::string path = "epd_test.epd";
+  const uint32_t N_REPETITIONS = 100;
+  std::vector<std::string> fens;
+  {
+    // Every position is followed by a blank or an invalid line, and the last
+    // line has no newline.
+    std::ofstream file(path, std::ios::binary);
+    for (uint32_t i = 0; i < N_REPETITIONS; i++) {
+      for (PerftTuple test : perft_tests) {
+        fens.push_back(test.fen);
+        file << test.fen << " bm e4 d4;id \"test." << fens.size()
+             << "\"; c0 \"a; b\"; noop;" << (i % 2 ? "\r\n" : "\n")
+             << (fens.size() % 3 ? "\n" : "8/8/8/8/8/8/8/8 w - -\n");
+      }
+    }
+    file << fen_standard;
+    fens.push_back(fen_standard);
+  }
+
+  EpdFile epd(path);
+  std::remove(path.c_str());
+  const std::vector<EpdPosition> &positions = epd.getPositions();
+  if (!epd.isOpen() || positions.size() != fens.size() ||
+      epd.getInvalidCount() != (fens.size() - 1) / 3) {
+    std::cout << "EPD loading failed! Expected: " << fens.size()
+              << " positions, but got: " << positions.size() << std::endl;
+    return;
+  }
+  for (uint32_t i = 0; i < positions.size(); i++) {
+    GameState game_state;
+    fenToGameState(fens[i], game_state);
+    bool last = i + 1 == positions.size();
+    std::string id = last ? "" : "test." + std::to_string(i + 1);
+    if (getPositionHash(positions[i].game_state) !=
+            getPositionHash(game_state) ||
+        positions[i].id != id ||
+        positions[i].best_moves != (last ? "" : "e4 d4") ||
+        positions[i].comment != (last ? "" : "a; b")) {
+      std::cout << "EPD loading failed at line: " << fens[i] << std::endl;
+      return;
+    }
+  }
+  std::cout << "EPD loading has succeeded! Positions: " << positions.size()
+            << "." << std::endl;
+}
+
+void testBatchAnalysis(void) {
+  struct AnalysisTest {
+    std::string line;
+    std::string expected;
+  };
+  // The expected JSON is checked up to the nodes and time, which vary.
+  const AnalysisTest tests[] = {
+      {"6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1 id \"mate\\in 1\";",
+       "{\"line\":1,\"id\":\"mate\\\\in 1\",\"bestmove\":\"a1a8\",\"score\":"
+       "32767,\"depth\":2,\"pv\":[\"a1a8\"],"},
+      {"6k1/5ppp/8/8/8/8/8/R5K1 w - - acd 3;",
+       "{\"line\":2,\"bestmove\":\"a1a8\",\"score\":32767,\"depth\":3,"
+       "\"pv\":[\"a1a8\"],"},
+      {"R5k1/5ppp/8/8/8/8/8/6K1 b - -",
+       "{\"line\":3,\"bestmove\":null,\"score\":-32767,\"depth\":2,\"pv\":[],"},
+      {"8/8/8/8 w - -",
+       std::string("{\"line\":4,\"error\":\"invalid fen: ") +
+           fenErrorToString(FEN_INVALID_BOARD) + "\"}"}};
+
+  std::string input;
+  std::vector<PrincipalVariation> pv(MAX_SEARCH_DEPTH + 1);
+  for (uint32_t i = 0; i < std::size(tests); i++) {
+    std::string result = analyzeLine(tests[i].line, i + 1, 2, pv.data());
+    if (!result.starts_with(tests[i].expected)) {
+      std::cout << "Batch analysis failed for: \"" << tests[i].line
+                << "\". Expected: " << tests[i].expected
+                << ", but got: " << result << std::endl;
+      return;
+    }
+    input += tests[i].line + "\n\n";
+  }
+
+  // Every line gets one result, in any order.
+  std::istringstream input_stream(input);
+  std::ostringstream output;
+  std::streambuf *cout_buffer = std::cout.rdbuf(output.rdbuf());
+  runBatchAnalysis(input_stream, 2, 3);
+  std::cout.rdbuf(cout_buffer);
+  std::string output_text = output.str();
+  for (uint32_t i = 0; i < std::size(tests); i++) {
+    std::string line = "{\"line\":" + std::to_string(2 * i + 1) + ",";
+    if ((size_t)std::count(output_text.begin(), output_text.end(), '\n') !=
+            std::size(tests) ||
+        output_text.find(line) == std::string::npos) {
+      std::cout << "Batch analysis failed! Output: " << output_text
+                << std::endl;
+      return;
+    }
+  }
+  std::cout << "Batch analysis has succeeded! Positions: " << std::size(tests)
+            << "." << std::endl;
+}
+
+/** Checks that the UCI position is the FEN with the moves applied, and that the
+ * session kept the moves.
+ *
+ * @param position: Position of the UCI session.
+ * @param fen: FEN of the expected position.
+ * @param moves: Moves of the expected position.
+ * @return True if the position matches.
+ */
+bool isSameUCIPosition(const UCIPosition &position, const std::string &fen,
+                       const std::vector<Move> &moves) {
+  GameState game_state;
+  fenToGameState(fen, game_state);
+  std::string moves_str;
+  for (Move move : moves) {
+    moves_str += (moves_str.empty() ? "" : " ") + move.toString();
+    applyMove(move, game_state);
+  }
+  const GameState &a = position.game_state;
+  return position.moves == moves_str &&
+         getPositionHash(a) == getPositionHash(game_state) &&
+         std::equal(a.board, a.board + N_SQUARES, game_state.board) &&
+         a.fullmove_number == game_state.fullmove_number;
+}
+
+void testUCIPosition(void) {
+  UCIPosition position;
+  UCIOptions options;
+  const Move E2E4(12, 28, PAWN_PUSH_2);
+  const Move E7E5(52, 36, PAWN_PUSH_2);
+  const Move E7E6(52, 44);
+
+  // A command extending the previous moves only applies the new ones, so the
+  // tampered move counter is kept.
+  UCIHandleInput("position startpos moves e2e4", position, options);
+  bool extended = isSameUCIPosition(position, fen_standard, {E2E4});
+  position.game_state.fullmove_number = 100;
+  UCIHandleInput("position startpos moves e2e4 e7e5", position, options);
+  extended = extended && position.moves == "e2e4 e7e5" &&
+             position.game_state.fullmove_number == 101;
+
+  // Diverging moves and a changed FEN rebuild the position.
+  UCIHandleInput("position startpos moves e2e4 e7e6", position, options);
+  bool diverged = isSameUCIPosition(position, fen_standard, {E2E4, E7E6});
+  const std::string fen = "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1";
+  UCIHandleInput("position fen " + fen + " moves e2e4", position, options);
+  bool changed_fen = isSameUCIPosition(position, fen, {E2E4});
+
+  // The moves stop at the first illegal one, and can be extended from there.
+  UCIHandleInput("position startpos moves e2e4 e2e4 e7e5", position, options);
+  bool illegal = isSameUCIPosition(position, fen_standard, {E2E4});
+  UCIHandleInput("position startpos moves e2e4 e7e5", position, options);
+  illegal = illegal && isSameUCIPosition(position, fen_standard, {E2E4, E7E5});
+
+  // A pawn capture 2 ranks ahead of another pawn is not a double push.
+  const std::string capture_fen = "4k3/8/8/3p4/4P3/3P4/8/4K3 w - - 0 1";
+  UCIHandleInput("position fen " + capture_fen + " moves e4d5", position,
+                 options);
+  bool decoded =
+      isSameUCIPosition(position, capture_fen, {Move(28, 35, NONE, true)});
+
+  UCIHandleInput("ucinewgame", position, options);
+  bool new_game = isSameUCIPosition(position, fen_standard, {});
+
+  if (!extended || !diverged || !changed_fen || !illegal || !decoded ||
+      !new_game) {
+    std::cout << "UCI position failed! Extended: " << extended
+              << ", diverged: " << diverged << ", changed fen: " << changed_fen
+              << ", illegal: " << illegal << ", decoded: " << decoded
+              << ", new game: " << new_game << std::endl;
+    return;
+  }
+  std::cout << "UCI position has succeeded!" << std::endl;
+}
+
+void testUCIOptions(void) {
+  UCIOptions options;
+  if (!options.set("threads", "4") || options.getSpin("Threads") != 4 ||
+      options.set("Threads", "0") || options.set("Hash", "16MB") ||
+      !options.set("ponder", "TRUE") || !options.getCheck("Ponder") ||
+      !options.set("LOG LEVEL", "debug") ||
+      options.getString("Log Level") != "Debug" ||
+      options.set("Log Level", "Verbose") ||
+      !options.set("Log File", "<empty>") ||
+      !options.getString("Log File").empty() || options.set("Unknown", "1") ||
+      options.getDeclarations().size() != 7) {
+    std::cout << "UCI options failed!" << std::endl;
+    return;
+  }
+
+  // The root search finds the same best move and score as negamax, on any
+  // number of threads, and with multiple lines.
+  const uint8_t DEPTH = 3;
+  for (PerftTuple test : perft_tests) {
+    GameState game_state;
+    fenToGameState(test.fen, game_state);
+    NegamaxTuple expected = negamax(
+        game_state, DEPTH, game_state.side_to_move == WHITE ? 1 : -1);
+    for (uint32_t n_threads : {1, 3}) {
+      for (uint8_t n_lines : {1, 4}) {
+        uint64_t nodes;
+        std::vector<RootMove> root_moves =
+            searchRootMoves(game_state, DEPTH, n_threads, n_lines, nodes);
+        if (root_moves.empty() || root_moves[0].score != expected.score ||
+            (n_threads == 1 && root_moves[0].move != expected.move) ||
+            root_moves[0].pv.moves[0] != root_moves[0].move) {
+          std::cout << "Root search failed for: " << test.fen
+                    << ". Threads: " << n_threads
+                    << ", lines: " << (int)n_lines << std::endl;
+          return;
+        }
+        for (uint8_t i = 1; n_lines > 1 && i < n_lines; i++) {
+          if (root_moves[i].score > root_moves[i - 1].score) {
+            std::cout << "Root search lines are not sorted for: " << test.fen
+                      << std::endl;
+            return;
+          }
+        }
+      }
+    }
+  }
+  std::cout << "UCI options have succeeded!" << std::endl;
+}
+
+void testAsyncLogger(void) {
+  const std::string path = "log_test.log";
+  const uint32_t N_THREADS = 4;
+  const uint32_t N_LINES = 5000;
+  std::remove(path.c_str());
+  setLogFile(path);
+  setLogLevel(LOG_INFO);
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < N_THREADS; i++) {
+    threads.emplace_back([i]() {
+      for (uint32_t j = 0; j < N_LINES; j++) {
+        writeToLog("thread " + std::to_string(i) + " line " + std::to_string(j),
+                   LOG_INFO);
+        writeToLog("not logged", LOG_DEBUG);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  stopLogger();
+  setLogLevel(LOG_OFF);
+
+  // Each thread's lines are in order, and every line is either written or
+  // counted as dropped.
+  std::ifstream file(path);
+  std::string line;
+  std::vector<int64_t> last_lines(N_THREADS, -1);
+  uint64_t n_lines = 0;
+  while (std::getline(file, line)) {
+    uint32_t thread;
+    int64_t line_number;
+    uint64_t n_dropped;
+    if (sscanf(line.c_str(), "thread %u line %ld", &thread, &line_number) ==
+            2 &&
+        thread < N_THREADS && line_number > last_lines[thread]) {
+      last_lines[thread] = line_number;
+      n_lines++;
+    } else if (sscanf(line.c_str(), "-- %lu log lines dropped --",
+                      &n_dropped) == 1) {
+      n_lines += n_dropped;
+    } else {
+      std::cout << "Async logger failed at line: " << line << std::endl;
+      std::remove(path.c_str());
+      return;
+    }
+  }
+  std::remove(path.c_str());
+  if (n_lines != N_THREADS * N_LINES) {
+    std::cout << "Async logger failed! Expected: " << N_THREADS * N_LINES
+              << " lines, but got: " << n_lines << std::endl;
+    return;
+  }
+  std::cout << "Async logger has succeeded! Lines: " << n_lines << "."
+            << std::endl;
+}
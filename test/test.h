@@ -4,3 +4,42 @@
  * every new change to source files.
  */
 void testAllPerft(void);
+
+/** Tests the pseudo-legality/legality checks of moves against the move
+ * generator, and the gives check test against applying the moves, on the perft
+ * test positions and their children.
+ */
+void testMoveValidation(void);
+
+/** Tests the FEN parser on valid and invalid FENs, and the move counters.
+ */
+void testFenParsing(void);
+
+/** Tests packing and unpacking positions, and writing and reading them back
+ * from a packed position file.
+ */
+void testPackedPositions(void);
+
+/** Tests loading an EPD file, with its operations, blank lines and invalid
+ * lines.
+ */
+void testEpdLoading(void);
+
+/** Tests the batch analysis of single lines, and of a stream of lines on
+ * multiple threads.
+ */
+void testBatchAnalysis(void);
+
+/** Tests the UCI position command: extending the previous moves, diverging
+ * from them, changing the FEN, stopping at an illegal move, and ucinewgame.
+ */
+void testUCIPosition(void);
+
+/** Tests the UCI option registry, and the root search used with the Threads
+ * and MultiPV options against negamax.
+ */
+void testUCIOptions(void);
+
+/** Tests the asynchronous logger with lines logged from multiple threads.
+ */
+void testAsyncLogger(void);